@@ -44,6 +44,9 @@ public:
 	// Amount of force the player exerts
 	static constexpr Number InputForce = 0.25;
 
+	// How objects are stepped through time
+	using Integrator = SemiImplicitEulerIntegrator;
+
 private:
 	RigidBody objects[8];
 
@@ -54,6 +57,8 @@ private:
 	bool gravityEnabled = false;
 	Vector2 gravitationalForce = Vector2(0, CoefficientOfGravity);
 
+	bool wrapAroundEnabled = false;
+
 	bool statRenderingEnabled = true;
 
 public:
@@ -143,6 +148,9 @@ public:
 		Display::println(gravityEnabled ? "ON" : "OFF");
 		Display::println(gravitationalForce.y < 0 ? "UP" : "DOWN");
 
+		Display::println("Wrap");
+		Display::println(wrapAroundEnabled ? "ON" : "OFF");
+
 		Display::print("G: ");
 		Display::println(static_cast<float>(CoefficientOfGravity));
 		Display::print("F: ");
@@ -174,6 +182,10 @@ public:
 			// Left - toggle statRenderingEnabled on/off
 			if(Buttons::held(BTN_LEFT, 1))
 				statRenderingEnabled = !statRenderingEnabled;
+
+			// Right - toggle wrapping around the screen edges on/off
+			if(Buttons::held(BTN_RIGHT, 1))
+				wrapAroundEnabled = !wrapAroundEnabled;
 		}
 		// Input for normal object control
 		else
@@ -202,86 +214,42 @@ public:
 		}
 	}
 
-	void simulatePhysics(void)
+	uint8_t getStepFeatures(void) const
 	{
-		using namespace Pokitto;
-
-		// Update objects
-		for(uint8_t i = 0; i < arrayLength(objects); ++i)
-		{
-			// object refers to the given item in the array
-			RigidBody & object = objects[i];
-
-			// First, simulate gravity
-			if(gravityEnabled)
-				object.velocity += gravitationalForce;
+		// If gravity is enabled, just simulate horizontal friction
+		// and gradually have objects come to a halt on the floor
+		// If gravity isn't enabled, simulate top-down friction
+		// and bounce off the y sides as well
+		const uint8_t features = gravityEnabled ?
+			(StepFeatures::Gravity | StepFeatures::RestitutionFloor) :
+			StepFeatures::TopDownFriction;
+
+		return wrapAroundEnabled ? (features | StepFeatures::WrapAround) : features;
+	}
 
-			// Then, simulate friction
-			if(gravityEnabled)
-				// If gravity is enabled, just simulate horizontal friction
-				object.velocity.x *= CoefficientOfFriction;
-			else
-				// If gravity isn't enabled, simulate top-down friction
-				object.velocity *= CoefficientOfFriction;
+	StepParameters getStepParameters(void) const
+	{
+		using namespace Pokitto;
 
-			// Then, keep the objects onscreen
-			// (A sort of cheaty way of keeping the objects onscreen)
+		StepParameters parameters;
+		parameters.gravity = gravitationalForce;
+		parameters.friction = CoefficientOfFriction;
+		parameters.restitution = CoefficientOfRestitution;
+		parameters.restitutionThreshold = RestitutionThreshold;
 
-			// They're literally bouncing off the walls :P
-			if(object.position.x < 0)
-			{
-				object.position.x = 0;
-				object.velocity.x = -object.velocity.x;
-			}
+		// Keep the objects onscreen
+		// (A sort of cheaty way of keeping the objects onscreen)
+		parameters.bounds = Rectangle(Number(0), Number(0), Size2(NumberU(Display::getWidth() - 8), NumberU(Display::getHeight() - 8)));
 
-			if(object.position.x > Display::getWidth() - 8)
-			{
-				object.position.x = (Display::getWidth() - 8);
-				object.velocity.x = -object.velocity.x;
-			}
+		return parameters;
+	}
 
-			if(gravityEnabled)
-			{
-				// If gravity is enabled, gradually have the object come to a halt
-				// This would be easier to understand with a diagram
-				if(object.position.y < 0)
-				{
-					object.position.y = 0;
-
-					if(object.velocity.y > RestitutionThreshold)
-						object.velocity.y = -object.velocity.y * CoefficientOfRestitution;
-					else
-						object.velocity.y = 0;
-				}
-				if(object.position.y > Display::getHeight() - 8)
-				{
-					object.position.y = (Display::getHeight() - 8);
-
-					if(object.velocity.y > RestitutionThreshold)
-						object.velocity.y = -object.velocity.y * CoefficientOfRestitution;
-					else
-						object.velocity.y = 0;
-				}
-			}
-			else
-			{
-				// If gravity isn't enabled, bounce off the y sides as well
-				if(object.position.y < 0)
-				{
-					object.position.y = 0;
-					object.velocity.y = -object.velocity.y;
-				}
-
-				if(object.position.y > Display::getHeight() - 8)
-				{
-					object.position.y = (Display::getHeight() - 8);
-					object.velocity.y = -object.velocity.y;
-				}
-			}
-
-			// Finally, update position using velocity
-			object.position += object.velocity;
-		}
+	void simulatePhysics(void)
+	{
+		// The modes can't change partway through a frame,
+		// so pick the step built for them once, rather than testing them for every object
+		const StepFunction step = getStepKernel<Integrator>(getStepFeatures());
+		step(objects, arrayLength(objects), getStepParameters());
 	}
 };
 
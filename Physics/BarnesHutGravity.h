@@ -0,0 +1,428 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "RigidBody.h"
+#include "Forces.h"
+
+//
+// N-body gravity using a Barnes-Hut quadtree
+//
+// The tree is rebuilt from the bodies every step.
+// Far away clusters of bodies are treated as a single body
+// sitting at their centre of mass, which brings the cost
+// down from O(n^2) to roughly O(n log n).
+//
+// Masses and centres of mass are accumulated as WideNumber so that
+// summing them over many heavy bodies can't overflow, and a node's pull
+// is worked out from its widened mass.
+//
+template< size_t CapacityValue, size_t NodeCapacityValue = (CapacityValue * 3) + 1 >
+class BarnesHutGravity
+{
+public:
+	static constexpr size_t Capacity = CapacityValue;
+	static constexpr size_t NodeCapacity = NodeCapacityValue;
+
+	// Past this depth bodies share a leaf instead of splitting further
+	static constexpr uint8_t MaxDepth = 12;
+
+	// Enough for a depth-first walk, which leaves at most 3 siblings behind per level
+	static constexpr size_t StackSize = ((MaxDepth * 3) + 1);
+
+	using IndexType = uint16_t;
+	static constexpr IndexType None = 0xFFFF;
+
+	static_assert(Capacity < None, "BarnesHutGravity capacity is too large for its index type");
+	static_assert(NodeCapacity < None, "BarnesHutGravity node capacity is too large for its index type");
+
+private:
+	class Node
+	{
+	public:
+		// Fields
+		WideNumber weightedX;
+		WideNumber weightedY;
+		WideNumber mass;
+		Point2 centreOfMass;
+		IndexType firstChild;
+		IndexType firstBody;
+		uint8_t depth;
+
+	public:
+		constexpr bool isLeaf(void) const
+		{
+			return (this->firstChild == None);
+		}
+	};
+
+private:
+	// Fields
+	Node nodes[NodeCapacity];
+	IndexType nextBodies[Capacity];
+	size_t nodeCount = 0;
+
+	Point2 rootCorner;
+	Number rootSize;
+
+	Number gravitationalConstant = 1;
+	Number openingAngle = 0.5;
+
+	// Stops bodies that get very close from flinging each other away
+	Number softening = 1;
+
+	// Node size squared for each depth
+	WideNumber sizesSquared[MaxDepth + 1];
+
+	// The opening angle squared, with Number's 16 fraction bits,
+	// and the largest value it can multiply without overflowing
+	int64_t openingAngleSquared;
+	int64_t openingLimit;
+
+public:
+	constexpr Number getGravitationalConstant(void) const
+	{
+		return this->gravitationalConstant;
+	}
+
+	void setGravitationalConstant(Number gravitationalConstant)
+	{
+		this->gravitationalConstant = gravitationalConstant;
+	}
+
+	constexpr Number getOpeningAngle(void) const
+	{
+		return this->openingAngle;
+	}
+
+	// Smaller is more accurate but slower, 0.5 is a common choice
+	// Must be greater than zero
+	void setOpeningAngle(Number openingAngle)
+	{
+		this->openingAngle = openingAngle;
+	}
+
+	constexpr Number getSoftening(void) const
+	{
+		return this->softening;
+	}
+
+	void setSoftening(Number softening)
+	{
+		this->softening = softening;
+	}
+
+	constexpr size_t getNodeCount(void) const
+	{
+		return this->nodeCount;
+	}
+
+	// Builds the tree then changes every body's velocity
+	// by the gravitational pull of all the others
+	// Only positions feed the pull, so velocities can be updated in place
+	// Acceleration is force over mass, so it goes straight onto the velocity
+	template< size_t size >
+	void apply(RigidBody (&bodies)[size])
+	{
+		this->build(bodies);
+
+		for(size_t i = 0; i < size; ++i)
+			bodies[i].velocity += this->getAcceleration(bodies, static_cast<IndexType>(i));
+	}
+
+	// The O(n^2) version, for small counts or for checking the tree's accuracy
+	template< size_t size >
+	void applyDirect(RigidBody (&bodies)[size]) const
+	{
+		for(size_t i = 0; i < size; ++i)
+			for(size_t j = 0; j < size; ++j)
+				if(j != i)
+					bodies[i].velocity += this->getPull(bodies[i].position, bodies[j].position, static_cast<WideNumber>(bodies[j].mass));
+	}
+
+	template< size_t size >
+	void build(const RigidBody (&bodies)[size])
+	{
+		static_assert(size <= Capacity, "BarnesHutGravity is too small for the body array");
+
+		this->nodeCount = 0;
+		if(size == 0)
+			return;
+
+		this->fitRoot(bodies);
+		this->updateOpeningTest();
+
+		this->nodeCount = 1;
+		this->resetNode(0, 0);
+
+		for(size_t i = 0; i < size; ++i)
+			this->insert(bodies, static_cast<IndexType>(i));
+
+		for(size_t i = 0; i < this->nodeCount; ++i)
+		{
+			Node & node = this->nodes[i];
+			if(node.mass > 0)
+				node.centreOfMass = Point2(divide(node.weightedX, node.mass), divide(node.weightedY, node.mass));
+		}
+	}
+
+	// Walks the tree without recursion, using a small fixed stack
+	template< size_t size >
+	Vector2 getAcceleration(const RigidBody (&bodies)[size], IndexType bodyIndex) const
+	{
+		Vector2 acceleration = Vector2(Number(0), Number(0));
+		if(this->nodeCount == 0)
+			return acceleration;
+
+		const Point2 position = bodies[bodyIndex].position;
+
+		IndexType stack[StackSize];
+		size_t stackCount = 0;
+		stack[stackCount] = 0;
+		++stackCount;
+
+		while(stackCount > 0)
+		{
+			--stackCount;
+			const Node & node = this->nodes[stack[stackCount]];
+
+			if(node.mass <= 0)
+				continue;
+
+			if(node.isLeaf())
+			{
+				for(IndexType index = node.firstBody; index != None; index = this->nextBodies[index])
+					if(index != bodyIndex)
+						acceleration += this->getPull(position, bodies[index].position, static_cast<WideNumber>(bodies[index].mass));
+
+				continue;
+			}
+
+			// Far enough away to be treated as one body
+			if(this->isFarEnough(node.depth, distanceSquaredWide(position, node.centreOfMass)))
+			{
+				acceleration += this->getPull(position, node.centreOfMass, node.mass);
+				continue;
+			}
+
+			for(IndexType child = 0; child < 4; ++child)
+			{
+				stack[stackCount] = (node.firstChild + child);
+				++stackCount;
+			}
+		}
+
+		return acceleration;
+	}
+
+private:
+	// Acceleration of a body at position towards a mass at source
+	Vector2 getPull(Point2 position, Point2 source, WideNumber mass) const
+	{
+		return getInverseSquarePull((source - position), this->getStrength(mass), this->softening);
+	}
+
+	// The gravitational constant times a mass, saturating rather than overflowing
+	WideNumber getStrength(WideNumber mass) const
+	{
+		// Both with Number's 16 fraction bits, so the product has a WideNumber's 32
+		const int64_t massInternal = (mass.getInternal() >> (WideNumber::FractionSize - Number::FractionSize));
+		const int64_t constant = this->gravitationalConstant.getInternal();
+
+		// Below 2^16 times a Number, the product can't overflow, so the divide is rarely needed
+		const bool isSmall = ((massInternal < (INT64_C(1) << 32)) && (massInternal > -(INT64_C(1) << 32)));
+		if(!isSmall && (constant != 0) && ((massInternal > 0) ? massInternal : -massInternal) > (INT64_MAX / ((constant > 0) ? constant : -constant)))
+			return (((massInternal > 0) == (constant > 0)) ? MaxWideNumber : -MaxWideNumber);
+
+		return WideNumber::fromInternal(massInternal * constant);
+	}
+
+	// The opening test, size < angle * distance, squared on both sides
+	// Dividing the size by the angle instead could overflow for a big node and a small angle
+	bool isFarEnough(uint8_t depth, WideNumber distanceSquared) const
+	{
+		// Dropping 16 fraction bits leaves the product with a WideNumber's 32
+		const int64_t distance = (distanceSquared.getInternal() >> Number::FractionSize);
+
+		// Too far away to even multiply out
+		if(distance > this->openingLimit)
+			return true;
+
+		return (this->sizesSquared[depth] < WideNumber::fromInternal(distance * this->openingAngleSquared));
+	}
+
+	template< size_t size >
+	void fitRoot(const RigidBody (&bodies)[size])
+	{
+		Number left = bodies[0].position.x;
+		Number right = left;
+		Number top = bodies[0].position.y;
+		Number bottom = top;
+
+		for(size_t i = 1; i < size; ++i)
+		{
+			const Point2 position = bodies[i].position;
+
+			if(position.x < left)
+				left = position.x;
+
+			if(position.x > right)
+				right = position.x;
+
+			if(position.y < top)
+				top = position.y;
+
+			if(position.y > bottom)
+				bottom = position.y;
+		}
+
+		const Number width = (right - left);
+		const Number height = (bottom - top);
+
+		// Pad by one so bodies on the far edges still land inside
+		this->rootCorner = Point2(left, top);
+		this->rootSize = (((width > height) ? width : height) + 1);
+	}
+
+	void updateOpeningTest(void)
+	{
+		Number size = this->rootSize;
+		for(uint8_t depth = 0; depth <= MaxDepth; ++depth)
+		{
+			this->sizesSquared[depth] = multiply(size, size);
+			size /= 2;
+		}
+
+		this->openingAngleSquared = (multiply(this->openingAngle, this->openingAngle).getInternal() >> (WideNumber::FractionSize - Number::FractionSize));
+		this->openingLimit = (this->openingAngleSquared > 0) ? (INT64_MAX / this->openingAngleSquared) : INT64_MAX;
+	}
+
+	void resetNode(IndexType index, uint8_t depth)
+	{
+		Node & node = this->nodes[index];
+		node.weightedX = 0;
+		node.weightedY = 0;
+		node.mass = 0;
+		node.firstChild = None;
+		node.firstBody = None;
+		node.depth = depth;
+	}
+
+	// Returns false if there isn't room for four more nodes
+	bool split(IndexType index)
+	{
+		if((this->nodeCount + 4) > NodeCapacity)
+			return false;
+
+		Node & node = this->nodes[index];
+		node.firstChild = static_cast<IndexType>(this->nodeCount);
+
+		for(uint8_t child = 0; child < 4; ++child)
+			this->resetNode(static_cast<IndexType>(this->nodeCount + child), (node.depth + 1));
+
+		this->nodeCount += 4;
+		return true;
+	}
+
+	static uint8_t getQuadrant(Point2 position, Point2 centre)
+	{
+		return ((position.x >= centre.x) ? 1 : 0) | ((position.y >= centre.y) ? 2 : 0);
+	}
+
+	static Point2 getChildCorner(Point2 corner, Number halfSize, uint8_t quadrant)
+	{
+		return Point2(((quadrant & 1) != 0) ? (corner.x + halfSize) : corner.x, ((quadrant & 2) != 0) ? (corner.y + halfSize) : corner.y);
+	}
+
+	static void accumulate(Node & node, const RigidBody & body)
+	{
+		node.weightedX += multiply(body.mass, body.position.x);
+		node.weightedY += multiply(body.mass, body.position.y);
+		node.mass += static_cast<WideNumber>(body.mass);
+	}
+
+	template< size_t size >
+	void insert(const RigidBody (&bodies)[size], IndexType bodyIndex)
+	{
+		const RigidBody & body = bodies[bodyIndex];
+
+		IndexType index = 0;
+		Point2 corner = this->rootCorner;
+		Number nodeSize = this->rootSize;
+
+		while(true)
+		{
+			Node & node = this->nodes[index];
+			accumulate(node, body);
+
+			const Number halfSize = (nodeSize / 2);
+			const Point2 centre = Point2(corner.x + halfSize, corner.y + halfSize);
+
+			if(node.isLeaf())
+			{
+				// Empty leaves, leaves at the depth limit,
+				// and leaves that can't be split all just take the body
+				if((node.firstBody == None) || (node.depth >= MaxDepth) || !this->split(index))
+				{
+					this->nextBodies[bodyIndex] = node.firstBody;
+					node.firstBody = bodyIndex;
+					return;
+				}
+
+				// Push the existing bodies down a level
+				// They've already been counted in this node, so only the child needs them
+				IndexType existing = node.firstBody;
+				node.firstBody = None;
+
+				while(existing != None)
+				{
+					const IndexType next = this->nextBodies[existing];
+					Node & child = this->nodes[node.firstChild + getQuadrant(bodies[existing].position, centre)];
+
+					accumulate(child, bodies[existing]);
+					this->nextBodies[existing] = child.firstBody;
+					child.firstBody = existing;
+
+					existing = next;
+				}
+			}
+
+			const uint8_t quadrant = getQuadrant(body.position, centre);
+			index = (node.firstChild + quadrant);
+			corner = getChildCorner(corner, halfSize, quadrant);
+			nodeSize = halfSize;
+		}
+	}
+};
+
+template< size_t CapacityValue, size_t NodeCapacityValue >
+constexpr size_t BarnesHutGravity<CapacityValue, NodeCapacityValue>::Capacity;
+
+template< size_t CapacityValue, size_t NodeCapacityValue >
+constexpr size_t BarnesHutGravity<CapacityValue, NodeCapacityValue>::NodeCapacity;
+
+template< size_t CapacityValue, size_t NodeCapacityValue >
+constexpr uint8_t BarnesHutGravity<CapacityValue, NodeCapacityValue>::MaxDepth;
+
+template< size_t CapacityValue, size_t NodeCapacityValue >
+constexpr size_t BarnesHutGravity<CapacityValue, NodeCapacityValue>::StackSize;
+
+template< size_t CapacityValue, size_t NodeCapacityValue >
+constexpr typename BarnesHutGravity<CapacityValue, NodeCapacityValue>::IndexType BarnesHutGravity<CapacityValue, NodeCapacityValue>::None;
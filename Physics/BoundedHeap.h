@@ -0,0 +1,166 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+
+// A binary heap living in a fixed-size array
+// Compare(a, b) returns true if a should sit above b,
+// so 'greater than' gives a max-heap and 'less than' gives a min-heap
+template< typename T, size_t CapacityValue, typename Compare >
+class BoundedHeap
+{
+public:
+	static constexpr size_t Capacity = CapacityValue;
+
+private:
+	// Fields
+	T items[Capacity];
+	size_t count = 0;
+
+public:
+	constexpr size_t getCount(void) const
+	{
+		return this->count;
+	}
+
+	constexpr bool isEmpty(void) const
+	{
+		return (this->count == 0);
+	}
+
+	constexpr bool isFull(void) const
+	{
+		return (this->count == Capacity);
+	}
+
+	// Undefined if the heap is empty
+	const T & getTop(void) const
+	{
+		return this->items[0];
+	}
+
+	// Items are in heap order, not sorted order
+	const T & operator [](size_t index) const
+	{
+		return this->items[index];
+	}
+
+	// Lets items be changed in place
+	// Any change must keep the items in the same relative order
+	T & operator [](size_t index)
+	{
+		return this->items[index];
+	}
+
+	void clear(void)
+	{
+		this->count = 0;
+	}
+
+	// Returns false if the heap is full
+	bool push(const T & item)
+	{
+		if(this->isFull())
+			return false;
+
+		size_t index = this->count;
+		++this->count;
+
+		// Sift up
+		while(index > 0)
+		{
+			const size_t parent = ((index - 1) / 2);
+
+			if(!Compare()(item, this->items[parent]))
+				break;
+
+			this->items[index] = this->items[parent];
+			index = parent;
+		}
+
+		this->items[index] = item;
+		return true;
+	}
+
+	// Undefined if the heap is empty
+	T pop(void)
+	{
+		const T result = this->items[0];
+
+		--this->count;
+		if(this->count > 0)
+			this->siftDown(this->items[this->count], 0);
+
+		return result;
+	}
+
+	// Swaps the top item for a new one, cheaper than pop then push
+	// Undefined if the heap is empty
+	void replaceTop(const T & item)
+	{
+		this->siftDown(item, 0);
+	}
+
+	// Removes every item the predicate returns true for,
+	// then puts the rest back in heap order
+	template< typename Predicate >
+	void removeIf(Predicate predicate)
+	{
+		size_t kept = 0;
+		for(size_t i = 0; i < this->count; ++i)
+			if(!predicate(this->items[i]))
+			{
+				this->items[kept] = this->items[i];
+				++kept;
+			}
+
+		this->count = kept;
+
+		for(size_t i = (this->count / 2); i > 0; --i)
+		{
+			const T item = this->items[i - 1];
+			this->siftDown(item, i - 1);
+		}
+	}
+
+private:
+	void siftDown(const T & item, size_t index)
+	{
+		while(true)
+		{
+			size_t child = ((index * 2) + 1);
+
+			if(child >= this->count)
+				break;
+
+			if(((child + 1) < this->count) && Compare()(this->items[child + 1], this->items[child]))
+				++child;
+
+			if(!Compare()(this->items[child], item))
+				break;
+
+			this->items[index] = this->items[child];
+			index = child;
+		}
+
+		this->items[index] = item;
+	}
+};
+
+template< typename T, size_t CapacityValue, typename Compare >
+constexpr size_t BoundedHeap<T, CapacityValue, Compare>::Capacity;
@@ -0,0 +1,59 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Segment.h"
+
+// A segment with a radius: a rectangle with round ends
+// Good for characters, which then slide over steps and slopes
+class Capsule
+{
+public:
+	// Fields
+	Segment segment;
+	NumberU radius;
+
+public:
+	// Constructors
+	constexpr Capsule(void) = default;
+	constexpr Capsule(Segment segment, NumberU radius) : segment(segment), radius(radius) {}
+	constexpr Capsule(Point2 start, Point2 end, NumberU radius) : segment(start, end), radius(radius) {}
+
+	constexpr Point2 getStart(void) const
+	{
+		return this->segment.start;
+	}
+
+	constexpr Point2 getEnd(void) const
+	{
+		return this->segment.end;
+	}
+
+	constexpr NumberU getRadiusSquared(void) const
+	{
+		return (this->radius * this->radius);
+	}
+
+	// Returns true if the point intersects the capsule
+	bool intersects(Point2 point) const
+	{
+		const Number radius = fromUnsigned(this->radius);
+		return (this->segment.getDistanceSquared(point) <= multiply(radius, radius));
+	}
+};
@@ -0,0 +1,376 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "Size.h"
+#include "Rectangle.h"
+
+// How far a box's bottom can be from a surface and still be standing on it,
+// since moving by a fraction of a motion can round a little either way
+constexpr Number GroundTolerance = 0.0625;
+
+class SweepHit
+{
+public:
+	// An enumerator rather than a static member, so it needs no definition
+	enum : size_t { None = SIZE_MAX };
+
+public:
+	// Fields
+
+	// Fraction of the motion completed before the hit, from 0 to 1
+	Number time = 1;
+
+	// Surface normal of whatever was hit
+	Vector2 normal = Vector2(Number(0), Number(0));
+
+	// Which piece of the world was hit
+	size_t index = None;
+
+public:
+	constexpr bool hasHit(void) const
+	{
+		return (this->index != None);
+	}
+};
+
+// Sweeps a box along motion against a single rectangle
+// Touching counts as a hit only when moving into the rectangle,
+// so a box can slide along a surface it rests on
+// Returns false if the box won't reach the rectangle this motion
+inline bool sweep(Rectangle box, Vector2 motion, Rectangle target, Number & time, Vector2 & normal)
+{
+	// Shrink the box to a point by growing the target by its size
+	const Number left = (target.getLeft() - fromUnsigned(box.getWidth()));
+	const Number right = target.getRight();
+	const Number top = (target.getTop() - fromUnsigned(box.getHeight()));
+	const Number bottom = target.getBottom();
+
+	Number entry = -1;
+	Number exit = 1;
+	Vector2 entryNormal = Vector2(Number(0), Number(0));
+
+	const Number starts[2] = { box.getX(), box.getY() };
+	const Number motions[2] = { motion.x, motion.y };
+	const Number minimums[2] = { left, top };
+	const Number maximums[2] = { right, bottom };
+
+	for(uint8_t axis = 0; axis < 2; ++axis)
+	{
+		const Number start = starts[axis];
+		const Number speed = motions[axis];
+
+		if(speed == 0)
+		{
+			// Not moving on this axis, so it must already be strictly inside the slab
+			if((start <= minimums[axis]) || (start >= maximums[axis]))
+				return false;
+
+			continue;
+		}
+
+		const Number near = (speed > 0) ? minimums[axis] : maximums[axis];
+		const Number far = (speed > 0) ? maximums[axis] : minimums[axis];
+
+		if((speed > 0) ? (start >= far) : (start <= far))
+			return false;
+
+		const Number toNear = (near - start);
+		const Number toFar = (far - start);
+
+		// The near side is ahead and further away than this motion reaches
+		if(((toNear > 0) == (speed > 0)) && (absFixed(toNear) > absFixed(speed)))
+			return false;
+
+		// Entry times before -1 and exit times after 1 can't change the result,
+		// so those divides are skipped rather than risk overflowing
+		if(absFixed(toNear) <= absFixed(speed))
+		{
+			const Number axisEntry = (toNear / speed);
+
+			if(axisEntry >= entry)
+			{
+				entry = axisEntry;
+				entryNormal = (axis == 0) ? Vector2((speed > 0) ? Number(-1) : Number(1), Number(0)) : Vector2(Number(0), (speed > 0) ? Number(-1) : Number(1));
+			}
+		}
+
+		if(absFixed(toFar) < absFixed(speed))
+		{
+			const Number axisExit = (toFar / speed);
+
+			if(axisExit < exit)
+				exit = axisExit;
+		}
+
+		if(entry >= exit)
+			return false;
+	}
+
+	// Already overlapping before moving, which a sweep can't resolve
+	if(entry < 0)
+		return false;
+
+	time = entry;
+	normal = entryNormal;
+	return true;
+}
+
+//
+// Static level geometry made of rectangles, as seen by a CharacterController
+//
+template< size_t CountValue >
+class RectangleWorld
+{
+public:
+	static constexpr size_t Count = CountValue;
+
+public:
+	// Fields
+	Rectangle rectangles[Count];
+
+public:
+	// Finds the first rectangle the box hits moving along motion
+	SweepHit sweep(Rectangle box, Vector2 motion) const
+	{
+		SweepHit result;
+
+		for(size_t i = 0; i < Count; ++i)
+		{
+			Number time;
+			Vector2 normal;
+
+			if(::sweep(box, motion, this->rectangles[i], time, normal) && (time < result.time))
+			{
+				result.time = time;
+				result.normal = normal;
+				result.index = i;
+			}
+		}
+
+		return result;
+	}
+
+	// Returns true if the given rectangle is still directly under the box
+	bool supports(size_t index, Rectangle box) const
+	{
+		const Rectangle & ground = this->rectangles[index];
+
+		return
+			(absFixed(box.getBottom() - ground.getTop()) <= GroundTolerance) &&
+			(box.getRight() > ground.getLeft()) &&
+			(box.getLeft() < ground.getRight());
+	}
+};
+
+template< size_t CountValue >
+constexpr size_t RectangleWorld<CountValue>::Count;
+
+//
+// A kinematic platformer character
+//
+// Movement is done with swept box casts, so the character never tunnels.
+// It can walk up steps no taller than stepHeight, and only stands on
+// surfaces whose normal points up steeply enough; anything else is a wall.
+//
+// While the character stays on the same surface the ground contact is
+// reused from the previous step, so no downward probe is needed.
+//
+// World must provide:
+//   SweepHit sweep(Rectangle box, Vector2 motion) const
+//   bool supports(size_t index, Rectangle box) const
+//
+class CharacterController
+{
+public:
+	// Fields
+	Rectangle bounds;
+	Vector2 velocity = Vector2(Number(0), Number(0));
+
+	Vector2 gravity = Vector2(Number(0), Number(0.5));
+	Number stepHeight = 4;
+
+	// Surfaces whose normal's y is more than this much upwards count as ground
+	// 0.7 allows slopes up to about 45 degrees
+	Number minimumGroundNormal = 0.7;
+
+private:
+	bool grounded = false;
+	size_t groundIndex = SweepHit::None;
+
+public:
+	// Constructors
+	CharacterController(Rectangle bounds) : bounds(bounds) {}
+
+	constexpr bool isGrounded(void) const
+	{
+		return this->grounded;
+	}
+
+	constexpr size_t getGroundIndex(void) const
+	{
+		return this->groundIndex;
+	}
+
+	// Call once per step, walk being the horizontal speed the player wants
+	template< typename World >
+	void update(const World & world, Number walk)
+	{
+		this->updateGround(world);
+
+		if(this->grounded)
+		{
+			if(this->velocity.y > 0)
+				this->velocity.y = 0;
+		}
+		else
+		{
+			this->velocity += this->gravity;
+		}
+
+		this->velocity.x = walk;
+
+		this->moveHorizontally(world, this->velocity.x);
+		this->moveVertically(world, this->velocity.y);
+	}
+
+	// Leaves the ground, if standing on it
+	void jump(Number speed)
+	{
+		if(!this->grounded)
+			return;
+
+		this->velocity.y = -speed;
+		this->grounded = false;
+		this->groundIndex = SweepHit::None;
+	}
+
+private:
+	bool isGround(Vector2 normal) const
+	{
+		return (-normal.y >= this->minimumGroundNormal);
+	}
+
+	template< typename World >
+	void updateGround(const World & world)
+	{
+		// Still on the cached surface, so there's nothing to check
+		if(this->grounded && (this->velocity.y >= 0) && world.supports(this->groundIndex, this->bounds))
+			return;
+
+		this->grounded = false;
+		this->groundIndex = SweepHit::None;
+
+		if(this->velocity.y < 0)
+			return;
+
+		// Probe from just above the feet to just below them for something to stand on
+		Rectangle probe = this->bounds;
+		probe.position.y -= GroundTolerance;
+
+		const Vector2 down = Vector2(Number(0), (GroundTolerance * 2));
+		const SweepHit hit = world.sweep(probe, down);
+		if(hit.hasHit() && this->isGround(hit.normal))
+		{
+			this->grounded = true;
+			this->groundIndex = hit.index;
+
+			// Snap onto the surface so the feet aren't left hovering or sunk in
+			this->bounds.position.y = (probe.getY() + (down.y * hit.time));
+		}
+	}
+
+	template< typename World >
+	void moveHorizontally(const World & world, Number distance)
+	{
+		if(distance == 0)
+			return;
+
+		const Vector2 motion = Vector2(distance, Number(0));
+		const SweepHit hit = world.sweep(this->bounds, motion);
+
+		if(!hit.hasHit())
+		{
+			this->bounds.position += motion;
+			return;
+		}
+
+		// Blocked while walking, so see if it's a step that can be climbed
+		if(this->grounded && this->tryStep(world, motion))
+			return;
+
+		this->bounds.position += (motion * hit.time);
+		this->velocity.x = 0;
+	}
+
+	// Up, across, then back down
+	// Only taken if it gets further than walking into the wall did
+	template< typename World >
+	bool tryStep(const World & world, Vector2 motion)
+	{
+		Rectangle raised = this->bounds;
+
+		const Vector2 up = Vector2(Number(0), -this->stepHeight);
+		const SweepHit upHit = world.sweep(raised, up);
+		raised.position += (up * upHit.time);
+
+		const SweepHit acrossHit = world.sweep(raised, motion);
+		if(acrossHit.hasHit())
+			return false;
+
+		raised.position += motion;
+
+		const Vector2 down = Vector2(Number(0), (this->bounds.getY() - raised.getY()));
+		const SweepHit downHit = world.sweep(raised, down);
+
+		if(!downHit.hasHit() || !this->isGround(downHit.normal))
+			return false;
+
+		raised.position += (down * downHit.time);
+		this->bounds = raised;
+		this->groundIndex = downHit.index;
+		return true;
+	}
+
+	template< typename World >
+	void moveVertically(const World & world, Number distance)
+	{
+		if(distance == 0)
+			return;
+
+		const Vector2 motion = Vector2(Number(0), distance);
+		const SweepHit hit = world.sweep(this->bounds, motion);
+
+		if(!hit.hasHit())
+		{
+			this->bounds.position += motion;
+			return;
+		}
+
+		this->bounds.position += (motion * hit.time);
+		this->velocity.y = 0;
+
+		if(this->isGround(hit.normal))
+		{
+			this->grounded = true;
+			this->groundIndex = hit.index;
+		}
+	}
+};
@@ -25,6 +25,14 @@
 using Number = SFixed<15, 16>;
 using NumberU = UFixed<16, 16>;
 
+// Wide enough to hold the product of two Numbers without losing anything
+using WideNumber = SFixed<30, 32>;
+
+// Copies of the largest values, so that using them at runtime
+// doesn't need out-of-line definitions of the FixedPoints constants
+constexpr Number MaxNumber = Number::MaxValue;
+constexpr WideNumber MaxWideNumber = WideNumber::MaxValue;
+
 constexpr inline NumberU fromSigned(Number value)
 {
 	return NumberU::fromInternal(value.getInternal());
@@ -35,12 +43,93 @@ constexpr inline Number fromUnsigned(NumberU value)
 	return Number::fromInternal(value.getInternal());
 }
 
+// Largest integer whose square is no greater than value
+inline uint32_t integerSquareRoot(uint64_t value)
+{
+	uint64_t result = 0;
+	uint64_t bit = (UINT64_C(1) << 62);
+
+	while(bit > value)
+		bit >>= 2;
+
+	while(bit != 0)
+	{
+		if(value >= (result + bit))
+		{
+			value -= (result + bit);
+			result = ((result >> 1) + bit);
+		}
+		else
+		{
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return static_cast<uint32_t>(result);
+}
+
+// A WideNumber has twice the fraction bits of a Number,
+// so the integer root of its internal value is already a Number
+// Negative values give 0 and results too large for Number saturate
+inline Number squareRoot(WideNumber value)
+{
+	if(value.getInternal() <= 0)
+		return 0;
+
+	const uint32_t root = integerSquareRoot(static_cast<uint64_t>(value.getInternal()));
+	return (root > static_cast<uint32_t>(MaxNumber.getInternal())) ? MaxNumber : Number::fromInternal(static_cast<int32_t>(root));
+}
+
+// Clamps a Number's worth of fraction bits into Number's range
+constexpr Number saturateNumber(int64_t internal)
+{
+	return Number::fromInternal(static_cast<int32_t>((internal > MaxNumber.getInternal()) ? MaxNumber.getInternal() : (internal < -MaxNumber.getInternal()) ? -MaxNumber.getInternal() : internal));
+}
+
+// Ratio of two widened values as a Number
+// Results too large for Number, including division by zero, saturate
+constexpr Number divide(WideNumber numerator, WideNumber denominator)
+{
+	return
+		(denominator.getInternal() == 0) ?
+			((numerator.getInternal() < 0) ? -MaxNumber : MaxNumber) :
+		// Shift the numerator up if there's room, otherwise shift the denominator down
+		((numerator.getInternal() < (INT64_C(1) << 46)) && (numerator.getInternal() > -(INT64_C(1) << 46))) ?
+			saturateNumber((numerator.getInternal() * (INT64_C(1) << Number::FractionSize)) / denominator.getInternal()) :
+		((denominator.getInternal() >> Number::FractionSize) != 0) ?
+			saturateNumber(numerator.getInternal() / (denominator.getInternal() >> Number::FractionSize)) :
+		(((numerator.getInternal() < 0) != (denominator.getInternal() < 0)) ? -MaxNumber : MaxNumber);
+}
+
+// Rounds a widened value to the nearest Number
+// Results too large for Number saturate
+constexpr Number narrow(WideNumber value)
+{
+	// Shifting in two steps rounds half up without any chance of overflow
+	return saturateNumber(((value.getInternal() >> (WideNumber::FractionSize - Number::FractionSize - 1)) + 1) >> 1);
+}
+
 template< typename T >
 constexpr auto square(T value) -> decltype(value * value)
 {
 	return value * value;
 }
 
+template< typename T >
+constexpr T clamp(T value, T minimum, T maximum)
+{
+	return (value < minimum) ? minimum : (value > maximum) ? maximum : value;
+}
+
+template< typename T >
+void swap(T & left, T & right)
+{
+	T temporary = left;
+	left = right;
+	right = temporary;
+}
+
 template< typename T, size_t size >
 constexpr size_t arrayLength(T (&)[size])
 {
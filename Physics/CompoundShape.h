@@ -0,0 +1,181 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "Rectangle.h"
+#include "Shape.h"
+
+//
+// Several shapes attached to one body, e.g. for cars or L-shaped blocks
+//
+// Children are given relative to the body's position.
+// Their world-space copies and the bounds around them all are cached,
+// and only worked out again when the body actually moves,
+// so a resting compound costs nothing to keep up to date.
+//
+template< uint8_t CapacityValue >
+class CompoundShape
+{
+public:
+	static constexpr uint8_t Capacity = CapacityValue;
+
+private:
+	// Fields
+	Shape localShapes[Capacity];
+	uint8_t count = 0;
+	Rectangle localBounds;
+
+	Shape worldShapes[Capacity];
+	Rectangle worldChildBounds[Capacity];
+	Rectangle worldBounds;
+	Point2 position = Point2(Number(0), Number(0));
+
+public:
+	constexpr uint8_t getCount(void) const
+	{
+		return this->count;
+	}
+
+	const Shape & getShape(uint8_t index) const
+	{
+		return this->worldShapes[index];
+	}
+
+	const Rectangle & getChildBounds(uint8_t index) const
+	{
+		return this->worldChildBounds[index];
+	}
+
+	constexpr Rectangle getLocalBounds(void) const
+	{
+		return this->localBounds;
+	}
+
+	constexpr Rectangle getBounds(void) const
+	{
+		return this->worldBounds;
+	}
+
+	constexpr Point2 getPosition(void) const
+	{
+		return this->position;
+	}
+
+	// Returns false if there's no room
+	bool add(const Shape & shape)
+	{
+		if(this->count >= Capacity)
+			return false;
+
+		this->localShapes[this->count] = shape;
+		++this->count;
+
+		this->updateLocalBounds();
+		this->updateWorld();
+		return true;
+	}
+
+	void clear(void)
+	{
+		this->count = 0;
+		this->localBounds = Rectangle();
+		this->updateWorld();
+	}
+
+	// Call once per step with the owning body's position
+	void update(Point2 position)
+	{
+		if(position == this->position)
+			return;
+
+		this->position = position;
+		this->updateWorld();
+	}
+
+private:
+	void updateLocalBounds(void)
+	{
+		this->localBounds = this->localShapes[0].getBounds();
+
+		for(uint8_t i = 1; i < this->count; ++i)
+			this->localBounds = getUnion(this->localBounds, this->localShapes[i].getBounds());
+	}
+
+	void updateWorld(void)
+	{
+		const Vector2 offset = (this->position - Point2(Number(0), Number(0)));
+
+		for(uint8_t i = 0; i < this->count; ++i)
+		{
+			this->worldShapes[i] = this->localShapes[i].getTranslated(offset);
+			this->worldChildBounds[i] = Rectangle((this->localShapes[i].getBounds().position + offset), this->localShapes[i].getBounds().size);
+		}
+
+		this->worldBounds = Rectangle((this->localBounds.position + offset), this->localBounds.size);
+	}
+};
+
+template< uint8_t CapacityValue >
+constexpr uint8_t CompoundShape<CapacityValue>::Capacity;
+
+// Children are only tested once the bounds overlap,
+// and each pair's bounds are checked before the exact test
+template< uint8_t FirstCapacity, uint8_t SecondCapacity >
+bool intersects(const CompoundShape<FirstCapacity> & first, const CompoundShape<SecondCapacity> & second)
+{
+	if(!intersects(first.getBounds(), second.getBounds()))
+		return false;
+
+	for(uint8_t i = 0; i < first.getCount(); ++i)
+	{
+		// Skip children that are nowhere near the other compound
+		if(!intersects(first.getChildBounds(i), second.getBounds()))
+			continue;
+
+		for(uint8_t j = 0; j < second.getCount(); ++j)
+			if(intersects(first.getChildBounds(i), second.getChildBounds(j)))
+				if(intersects(first.getShape(i), second.getShape(j)))
+					return true;
+	}
+
+	return false;
+}
+
+template< uint8_t Capacity >
+bool intersects(const CompoundShape<Capacity> & compound, const Shape & shape)
+{
+	const Rectangle bounds = shape.getBounds();
+
+	if(!intersects(compound.getBounds(), bounds))
+		return false;
+
+	for(uint8_t i = 0; i < compound.getCount(); ++i)
+		if(intersects(compound.getChildBounds(i), bounds))
+			if(intersects(compound.getShape(i), shape))
+				return true;
+
+	return false;
+}
+
+template< uint8_t Capacity >
+bool intersects(const Shape & shape, const CompoundShape<Capacity> & compound)
+{
+	return intersects(compound, shape);
+}
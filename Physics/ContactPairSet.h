@@ -0,0 +1,319 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Intersections.h"
+
+//
+// What's remembered about a touching pair between frames
+//
+class ContactManifold
+{
+public:
+	// Fields
+	Contact contact;
+
+	// Impulse applied along the normal last frame, for warm starting a solver
+	Number normalImpulse = 0;
+
+	// The frame the pair started touching
+	uint16_t firstFrame = 0;
+};
+
+//
+// A fixed-size open-addressing hash set of touching body pairs
+//
+// Pairs are keyed by their (smaller, larger) 16-bit body IDs.
+// Rather than clearing the table every frame, each entry is stamped with
+// the last frame it was touched. Anything not touched this frame or last
+// counts as expired and its slot is reused by later inserts.
+//
+// Expired entries still have to be probed past, so once more than
+// three quarters of the slots have been used, beginFrame drops the
+// expired entries and puts the rest back where they'd be in a clean table.
+//
+// Capacity must be a power of two
+//
+template< size_t CapacityValue >
+class ContactPairSet
+{
+public:
+	static constexpr size_t Capacity = CapacityValue;
+
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+	static_assert(Capacity <= 0x10000, "Capacity must fit a 16-bit index");
+
+private:
+	static constexpr uint32_t EmptyKey = UINT32_MAX;
+	static constexpr size_t MaxUsed = ((Capacity / 4) * 3);
+
+	class Entry
+	{
+	public:
+		uint32_t key = EmptyKey;
+		uint16_t stamp = 0;
+		ContactManifold manifold;
+	};
+
+private:
+	// Fields
+	Entry entries[Capacity];
+
+	// Starts at 2 so that the zero stamps of a fresh table are expired
+	uint16_t frame = 2;
+
+	// Slots that aren't empty, whether their entries have expired or not
+	size_t used = 0;
+
+public:
+	static constexpr uint32_t getKey(uint16_t first, uint16_t second)
+	{
+		return (first < second) ? ((static_cast<uint32_t>(first) << 16) | second) : ((static_cast<uint32_t>(second) << 16) | first);
+	}
+
+	constexpr uint16_t getFrame(void) const
+	{
+		return this->frame;
+	}
+
+	constexpr size_t getUsed(void) const
+	{
+		return this->used;
+	}
+
+	// Call before the narrow phase each frame
+	void beginFrame(void)
+	{
+		++this->frame;
+
+		// Stamps are compared by wrapping subtraction, so only an entry left
+		// untouched for a whole lap of the counter could look fresh again.
+		// Dropping expired entries once a lap rules that out and keeps live ones.
+		if((this->frame == 0) || (this->used > MaxUsed))
+			this->compact();
+	}
+
+	void clear(void)
+	{
+		for(size_t i = 0; i < Capacity; ++i)
+			this->entries[i] = Entry();
+
+		this->frame = 2;
+		this->used = 0;
+	}
+
+	// Drops the expired entries so lookups don't have to probe past them
+	void compact(void)
+	{
+		this->rehash([](uint32_t key) { return key; });
+	}
+
+	// Records that a pair is touching this frame
+	// Returns nullptr if the table has no room
+	// isNew is set if the pair wasn't touching last frame
+	ContactManifold * touch(uint16_t first, uint16_t second, bool & isNew)
+	{
+		const uint32_t key = getKey(first, second);
+
+		Entry * reusable = nullptr;
+
+		for(size_t probe = 0, index = getHash(key); probe < Capacity; ++probe, index = ((index + 1) & (Capacity - 1)))
+		{
+			Entry & entry = this->entries[index];
+
+			if(entry.key == EmptyKey)
+			{
+				if(reusable == nullptr)
+					reusable = &entry;
+
+				break;
+			}
+
+			if(entry.key == key)
+			{
+				// A pair that lapsed and came back starts over
+				isNew = this->isExpired(entry);
+				if(isNew)
+					this->reset(entry);
+
+				entry.stamp = this->frame;
+				return &entry.manifold;
+			}
+
+			// Keep probing past expired entries, the pair may be further on
+			if((reusable == nullptr) && this->isExpired(entry))
+				reusable = &entry;
+		}
+
+		if(reusable == nullptr)
+			return nullptr;
+
+		if(reusable->key == EmptyKey)
+			++this->used;
+
+		isNew = true;
+		reusable->key = key;
+		this->reset(*reusable);
+		reusable->stamp = this->frame;
+		return &reusable->manifold;
+	}
+
+	// Returns nullptr unless the pair was touching this frame or last
+	const ContactManifold * find(uint16_t first, uint16_t second) const
+	{
+		const uint32_t key = getKey(first, second);
+
+		for(size_t probe = 0, index = getHash(key); probe < Capacity; ++probe, index = ((index + 1) & (Capacity - 1)))
+		{
+			const Entry & entry = this->entries[index];
+
+			if(entry.key == EmptyKey)
+				return nullptr;
+
+			if(entry.key == key)
+				return this->isExpired(entry) ? nullptr : &entry.manifold;
+		}
+
+		return nullptr;
+	}
+
+	// Renumbers the bodies in every pair, after the bodies have been reordered
+	// newIndices[oldIndex] gives each body's new index
+	// Expired pairs are dropped
+	void remap(const uint16_t * newIndices)
+	{
+		this->rehash([newIndices](uint32_t key)
+		{
+			return getKey(newIndices[key >> 16], newIndices[key & 0xFFFF]);
+		});
+	}
+
+	// Calls action(first, second, manifold) for every pair that was touching
+	// last frame but hasn't been touched this frame
+	// Only meaningful after the narrow phase has finished
+	template< typename Action >
+	void forEachEnded(Action action) const
+	{
+		const uint16_t previous = (this->frame - 1);
+
+		for(size_t i = 0; i < Capacity; ++i)
+		{
+			const Entry & entry = this->entries[i];
+
+			if((entry.key != EmptyKey) && (entry.stamp == previous))
+				action(static_cast<uint16_t>(entry.key >> 16), static_cast<uint16_t>(entry.key & 0xFFFF), entry.manifold);
+		}
+	}
+
+private:
+	// Drops expired entries, gives the rest new keys from getNewKey(oldKey),
+	// and moves each one to where it belongs in a clean table
+	template< typename KeyFunction >
+	void rehash(KeyFunction getNewKey)
+	{
+		this->used = 0;
+
+		// Entries still waiting to be moved to their new home
+		uint8_t pending[(Capacity + 7) / 8] = {};
+
+		for(size_t i = 0; i < Capacity; ++i)
+		{
+			Entry & entry = this->entries[i];
+
+			if(entry.key == EmptyKey)
+				continue;
+
+			if(this->isExpired(entry))
+			{
+				entry = Entry();
+				continue;
+			}
+
+			entry.key = getNewKey(entry.key);
+			pending[i / 8] |= (1 << (i % 8));
+			++this->used;
+		}
+
+		// Each pending entry is lifted out and placed at the first slot on its
+		// probe path that's empty or still pending, carrying on with whatever
+		// was displaced. Placed entries never move again, so no probe path
+		// ends up with a gap in it.
+		for(size_t i = 0; i < Capacity; ++i)
+		{
+			if((pending[i / 8] & (1 << (i % 8))) == 0)
+				continue;
+
+			Entry carried = this->entries[i];
+			this->entries[i] = Entry();
+			pending[i / 8] &= ~(1 << (i % 8));
+
+			for(bool isPlaced = false; !isPlaced;)
+				for(size_t index = getHash(carried.key);; index = ((index + 1) & (Capacity - 1)))
+				{
+					Entry & entry = this->entries[index];
+
+					if(entry.key == EmptyKey)
+					{
+						entry = carried;
+						isPlaced = true;
+						break;
+					}
+
+					// Take its slot, then find a home for the one that was there
+					if((pending[index / 8] & (1 << (index % 8))) != 0)
+					{
+						swap(entry, carried);
+						pending[index / 8] &= ~(1 << (index % 8));
+						break;
+					}
+				}
+		}
+	}
+
+	static constexpr size_t getHash(uint32_t key)
+	{
+		// Fibonacci hashing, taking the top bits
+		return static_cast<size_t>((key * UINT32_C(2654435761)) >> (32 - getShift(Capacity))) & (Capacity - 1);
+	}
+
+	static constexpr uint8_t getShift(size_t value)
+	{
+		return (value <= 1) ? 0 : (1 + getShift(value >> 1));
+	}
+
+	// Wrap-safe, as long as nothing expired survives a whole lap of the frame counter
+	bool isExpired(const Entry & entry) const
+	{
+		return (static_cast<uint16_t>(this->frame - entry.stamp) > 1);
+	}
+
+	void reset(Entry & entry) const
+	{
+		entry.manifold = ContactManifold();
+		entry.manifold.firstFrame = this->frame;
+	}
+};
+
+template< size_t CapacityValue >
+constexpr size_t ContactPairSet<CapacityValue>::Capacity;
+
+template< size_t CapacityValue >
+constexpr uint32_t ContactPairSet<CapacityValue>::EmptyKey;
+
+template< size_t CapacityValue >
+constexpr size_t ContactPairSet<CapacityValue>::MaxUsed;
@@ -0,0 +1,465 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "Rectangle.h"
+#include "RigidBody.h"
+#include "BoundedHeap.h"
+
+enum class SimulationEventType : uint8_t
+{
+	// Two bodies touch
+	Collision,
+	// A body touches one of the walls
+	HorizontalWall,
+	VerticalWall,
+	// Nothing happens, the body's events are just predicted again
+	// This catches anything too far in the future to predict accurately
+	Recheck,
+};
+
+class SimulationEvent
+{
+public:
+	// Fields
+	Number time;
+	SimulationEventType type;
+	uint8_t first;
+	uint8_t second;
+
+	// Versions of the bodies when this event was predicted
+	// If either body has changed since then, the event is stale
+	uint16_t firstVersion;
+	uint16_t secondVersion;
+};
+
+struct EarliestEventFirst
+{
+	constexpr bool operator ()(const SimulationEvent & left, const SimulationEvent & right) const
+	{
+		return (left.time < right.time);
+	}
+};
+
+//
+// Event-driven simulation of circles inside a box, for pool and pinball style scenes
+//
+// Instead of stepping in fixed increments, the exact time of the next impact
+// is worked out analytically and the simulation jumps straight to it,
+// so impacts always happen in the right order and nothing tunnels.
+//
+// Predicted events wait in a fixed-size heap ordered by time.
+// When a body's velocity changes its version number goes up,
+// which quietly invalidates every event that was predicted with the old one.
+//
+// Every prediction follows a version change, so at most one event per pair
+// of bodies is current, plus two walls and a recheck per body. The default
+// EventCapacity holds all of those. When the heap fills up the stale events
+// are thrown out to make room; with a smaller EventCapacity than the default
+// the simulation may still have to start its predictions over.
+//
+// Time is measured in ticks, one tick being one Game::simulatePhysics step.
+// Each body remembers the time its position was last brought up to date,
+// so only bodies involved in an event need to be moved.
+//
+template< uint8_t CapacityValue, size_t EventCapacityValue = ((CapacityValue * (CapacityValue + 5)) / 2) >
+class EventSimulation
+{
+public:
+	static constexpr uint8_t Capacity = CapacityValue;
+	static constexpr size_t EventCapacity = EventCapacityValue;
+
+	// Events are never predicted further ahead than this
+	static constexpr Number Horizon = 64;
+
+	// Stops bodies resting against each other from stalling a frame
+	static constexpr uint16_t MaxEventsPerAdvance = 256;
+
+private:
+	// Fields
+	RigidBody bodies[Capacity];
+	Number radii[Capacity];
+	Number times[Capacity];
+	uint16_t versions[Capacity];
+	uint8_t bodyCount = 0;
+
+	Rectangle bounds;
+	Number restitution = 1;
+	Number time = 0;
+
+	BoundedHeap<SimulationEvent, EventCapacity, EarliestEventFirst> events;
+
+	// Set if an event didn't fit in the heap
+	bool needsRebuild = false;
+
+public:
+	// Constructors
+	EventSimulation(Rectangle bounds) : bounds(bounds) {}
+
+	constexpr uint8_t getBodyCount(void) const
+	{
+		return this->bodyCount;
+	}
+
+	const RigidBody & getBody(uint8_t index) const
+	{
+		return this->bodies[index];
+	}
+
+	constexpr Number getRadius(uint8_t index) const
+	{
+		return this->radii[index];
+	}
+
+	constexpr Number getRestitution(void) const
+	{
+		return this->restitution;
+	}
+
+	void setRestitution(Number restitution)
+	{
+		this->restitution = restitution;
+	}
+
+	// Returns the new body's index, or Capacity if there's no room
+	uint8_t addBody(const RigidBody & body, Number radius)
+	{
+		if(this->bodyCount >= Capacity)
+			return Capacity;
+
+		const uint8_t index = this->bodyCount;
+		++this->bodyCount;
+
+		this->bodies[index] = body;
+		this->radii[index] = radius;
+		this->times[index] = this->time;
+		this->versions[index] = 0;
+
+		this->predict(index);
+		return index;
+	}
+
+	// Changing a body from outside (e.g. a cue strike) needs new predictions
+	void setVelocity(uint8_t index, Vector2 velocity)
+	{
+		this->moveToTime(index);
+		this->bodies[index].velocity = velocity;
+		this->invalidate(index);
+		this->predict(index);
+	}
+
+	// Runs every event up to time + ticks, then brings every body up to date
+	void advance(Number ticks)
+	{
+		if(this->needsRebuild)
+			this->rebuild();
+
+		const Number target = (this->time + ticks);
+
+		for(uint16_t handled = 0; (handled < MaxEventsPerAdvance) && !this->events.isEmpty(); )
+		{
+			if(this->events.getTop().time > target)
+				break;
+
+			const SimulationEvent event = this->events.pop();
+
+			if(!this->isCurrent(event))
+				continue;
+
+			++handled;
+			this->time = event.time;
+			this->handle(event);
+
+			// Something didn't fit, so predict everything again from here
+			if(this->needsRebuild)
+				this->rebuild();
+		}
+
+		this->time = target;
+		for(uint8_t i = 0; i < this->bodyCount; ++i)
+			this->moveToTime(i);
+
+		// Keep the clock near zero so it can't overflow
+		this->rebase();
+	}
+
+private:
+	bool isCurrent(const SimulationEvent & event) const
+	{
+		if(this->versions[event.first] != event.firstVersion)
+			return false;
+
+		if((event.type == SimulationEventType::Collision) && (this->versions[event.second] != event.secondVersion))
+			return false;
+
+		return true;
+	}
+
+	void invalidate(uint8_t index)
+	{
+		++this->versions[index];
+
+		// After wrapping, an old event could match the new version,
+		// so forget everything involving this body
+		if(this->versions[index] == 0)
+			this->events.removeIf([index](const SimulationEvent & event)
+			{
+				return ((event.first == index) || (event.second == index));
+			});
+	}
+
+	void moveToTime(uint8_t index)
+	{
+		RigidBody & body = this->bodies[index];
+		const Number elapsed = (this->time - this->times[index]);
+
+		body.position += (body.velocity * elapsed);
+		this->times[index] = this->time;
+	}
+
+	Point2 getPositionAt(uint8_t index, Number time) const
+	{
+		const RigidBody & body = this->bodies[index];
+		return (body.position + (body.velocity * (time - this->times[index])));
+	}
+
+	void push(SimulationEventType type, Number time, uint8_t first, uint8_t second)
+	{
+		const SimulationEvent event = { time, type, first, second, this->versions[first], this->versions[second] };
+
+		if(this->events.push(event))
+			return;
+
+		// Make room by throwing out the stale events
+		this->events.removeIf([this](const SimulationEvent & event)
+		{
+			return !this->isCurrent(event);
+		});
+
+		if(!this->events.push(event))
+			this->needsRebuild = true;
+	}
+
+	// Predicts the next events involving the given body
+	// The pair with skip is left out, for when it has just been predicted
+	void predict(uint8_t index, uint8_t skip = Capacity)
+	{
+		for(uint8_t other = 0; other < this->bodyCount; ++other)
+			if((other != index) && (other != skip))
+				this->predictCollision(index, other);
+
+		this->predictBoundaries(index);
+	}
+
+	void predictCollision(uint8_t index, uint8_t other)
+	{
+		const Number impact = this->getImpactTime(index, other);
+		if(impact <= Horizon)
+			this->push(SimulationEventType::Collision, (this->time + impact), index, other);
+	}
+
+	// Predicts the wall hits and the recheck for the given body
+	void predictBoundaries(uint8_t index)
+	{
+		const Number limit = (this->time + Horizon);
+
+		const RigidBody & body = this->bodies[index];
+		const Point2 position = this->getPositionAt(index, this->time);
+		const Number radius = this->radii[index];
+
+		const Number wallX = getWallTime(position.x, body.velocity.x, (this->bounds.getLeft() + radius), (this->bounds.getRight() - radius));
+		if(wallX <= Horizon)
+			this->push(SimulationEventType::VerticalWall, (this->time + wallX), index, index);
+
+		const Number wallY = getWallTime(position.y, body.velocity.y, (this->bounds.getTop() + radius), (this->bounds.getBottom() - radius));
+		if(wallY <= Horizon)
+			this->push(SimulationEventType::HorizontalWall, (this->time + wallY), index, index);
+
+		this->push(SimulationEventType::Recheck, limit, index, index);
+	}
+
+	// Time from now until the body reaches minimum or maximum, or more than Horizon if it won't
+	static Number getWallTime(Number position, Number velocity, Number minimum, Number maximum)
+	{
+		if(velocity > 0)
+			return clampTime((maximum - position), velocity);
+
+		if(velocity < 0)
+			return clampTime((minimum - position), velocity);
+
+		return (Horizon + 1);
+	}
+
+	// distance / velocity, without overflowing when it would be past the horizon
+	static Number clampTime(Number distance, Number velocity)
+	{
+		// Already past the wall while moving towards it
+		if((distance > 0) != (velocity > 0))
+			return 0;
+
+		if(multiply(absFixed(velocity), Horizon) < static_cast<WideNumber>(absFixed(distance)))
+			return (Horizon + 1);
+
+		return (distance / velocity);
+	}
+
+	// Solves |offset + relativeVelocity * t| = combined radius for the earliest t
+	// Returns more than Horizon if the bodies won't meet
+	Number getImpactTime(uint8_t first, uint8_t second) const
+	{
+		const Vector2 offset = (this->getPositionAt(second, this->time) - this->getPositionAt(first, this->time));
+		const Vector2 relativeVelocity = (this->bodies[second].velocity - this->bodies[first].velocity);
+		const Number combinedRadius = (this->radii[first] + this->radii[second]);
+
+		const WideNumber a = relativeVelocity.getMagnitudeSquaredWide();
+		const WideNumber b = dotWide(offset, relativeVelocity);
+		const WideNumber c = (offset.getMagnitudeSquaredWide() - multiply(combinedRadius, combinedRadius));
+
+		// Moving apart, or not moving relative to each other
+		if((b >= 0) || (a <= 0))
+			return (Horizon + 1);
+
+		// Already overlapping and approaching
+		if(c <= 0)
+			return 0;
+
+		// Dividing through by a keeps everything in units of ticks
+		// t = -b' - sqrt(b'^2 - c')
+		const Number halfB = divide(b, a);
+		const Number scaledC = divide(c, a);
+
+		// c' is the product of both roots, so if it saturated
+		// the impact is too far off or too slow to matter yet
+		if(scaledC.getInternal() >= MaxNumber.getInternal())
+			return (Horizon + 1);
+
+		const WideNumber discriminant = (multiply(halfB, halfB) - static_cast<WideNumber>(scaledC));
+		if(discriminant < 0)
+			return (Horizon + 1);
+
+		const Number impact = (-halfB - squareRoot(discriminant));
+		return (impact < 0) ? Number(0) : impact;
+	}
+
+	void handle(const SimulationEvent & event)
+	{
+		const uint8_t first = event.first;
+		const uint8_t second = event.second;
+
+		this->moveToTime(first);
+
+		switch(event.type)
+		{
+			case SimulationEventType::Collision:
+				this->moveToTime(second);
+				this->collide(first, second);
+				this->invalidate(first);
+				this->invalidate(second);
+				this->predict(first);
+				this->predict(second, first);
+				return;
+
+			case SimulationEventType::VerticalWall:
+				this->bodies[first].velocity.x = (-this->bodies[first].velocity.x * this->restitution);
+				break;
+
+			case SimulationEventType::HorizontalWall:
+				this->bodies[first].velocity.y = (-this->bodies[first].velocity.y * this->restitution);
+				break;
+
+			case SimulationEventType::Recheck:
+				break;
+		}
+
+		this->invalidate(first);
+		this->predict(first);
+	}
+
+	void collide(uint8_t first, uint8_t second)
+	{
+		RigidBody & firstBody = this->bodies[first];
+		RigidBody & secondBody = this->bodies[second];
+
+		// The bodies are exactly touching, so the distance between them
+		// is their combined radius and no square root is needed
+		const Number combinedRadius = (this->radii[first] + this->radii[second]);
+		const Vector2 offset = (secondBody.position - firstBody.position);
+		const Vector2 normal = Vector2((offset.x / combinedRadius), (offset.y / combinedRadius));
+
+		const Vector2 relativeVelocity = (secondBody.velocity - firstBody.velocity);
+		const Number approach = dot(relativeVelocity, normal);
+
+		if(approach >= 0)
+			return;
+
+		const Number firstInverseMass = (1 / firstBody.mass);
+		const Number secondInverseMass = (1 / secondBody.mass);
+		const Number impulse = ((-(1 + this->restitution) * approach) / (firstInverseMass + secondInverseMass));
+
+		firstBody.velocity -= (normal * (impulse * firstInverseMass));
+		secondBody.velocity += (normal * (impulse * secondInverseMass));
+	}
+
+	// Throws away every prediction and starts again
+	void rebuild(void)
+	{
+		this->needsRebuild = false;
+		this->events.clear();
+
+		for(uint8_t i = 0; i < this->bodyCount; ++i)
+			this->moveToTime(i);
+
+		// Each pair is only predicted once
+		for(uint8_t i = 0; i < this->bodyCount; ++i)
+		{
+			for(uint8_t other = 0; other < i; ++other)
+				this->predictCollision(i, other);
+
+			this->predictBoundaries(i);
+		}
+	}
+
+	// Every body is up to date after advance, so the clock can be reset to zero
+	// Shifting every pending event by the same amount keeps the heap in order
+	void rebase(void)
+	{
+		const Number offset = this->time;
+
+		for(size_t i = 0; i < this->events.getCount(); ++i)
+			this->events[i].time -= offset;
+
+		for(uint8_t i = 0; i < this->bodyCount; ++i)
+			this->times[i] = 0;
+
+		this->time = 0;
+	}
+};
+
+template< uint8_t CapacityValue, size_t EventCapacityValue >
+constexpr uint8_t EventSimulation<CapacityValue, EventCapacityValue>::Capacity;
+
+template< uint8_t CapacityValue, size_t EventCapacityValue >
+constexpr size_t EventSimulation<CapacityValue, EventCapacityValue>::EventCapacity;
+
+template< uint8_t CapacityValue, size_t EventCapacityValue >
+constexpr Number EventSimulation<CapacityValue, EventCapacityValue>::Horizon;
+
+template< uint8_t CapacityValue, size_t EventCapacityValue >
+constexpr uint16_t EventSimulation<CapacityValue, EventCapacityValue>::MaxEventsPerAdvance;
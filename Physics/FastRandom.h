@@ -0,0 +1,47 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+// Marsaglia's xorshift, fast and small but not for anything important
+class FastRandom
+{
+private:
+	// Fields
+	uint32_t state = 2463534242;
+
+public:
+	// Constructors
+	constexpr FastRandom(void) = default;
+
+	// A seed of zero would get stuck, so it's nudged
+	constexpr FastRandom(uint32_t seed) : state((seed != 0) ? seed : 2463534242) {}
+
+	uint32_t next(void)
+	{
+		this->state ^= (this->state << 13);
+		this->state ^= (this->state >> 17);
+		this->state ^= (this->state << 5);
+		return this->state;
+	}
+
+	bool nextBool(void)
+	{
+		return ((this->next() & 0x80000000) != 0);
+	}
+};
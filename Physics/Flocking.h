@@ -0,0 +1,173 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "RigidBody.h"
+
+class FlockSettings
+{
+public:
+	// Fields
+	Number separationWeight;
+	Number alignmentWeight;
+	Number cohesionWeight;
+
+	// Only bodies this close count as neighbours
+	Number neighbourRadius;
+
+	// Neighbours this close are steered away from
+	Number separationRadius;
+
+	Number maximumSpeed;
+	Number maximumSteering;
+
+	// Stops crowded areas from costing more than sparse ones
+	uint8_t maximumNeighbours;
+
+public:
+	// Constructors
+	FlockSettings(void) = default;
+	constexpr FlockSettings(Number separationWeight, Number alignmentWeight, Number cohesionWeight, Number neighbourRadius, Number separationRadius, Number maximumSpeed, Number maximumSteering, uint8_t maximumNeighbours)
+		: separationWeight(separationWeight), alignmentWeight(alignmentWeight), cohesionWeight(cohesionWeight), neighbourRadius(neighbourRadius), separationRadius(separationRadius), maximumSpeed(maximumSpeed), maximumSteering(maximumSteering), maximumNeighbours(maximumNeighbours)
+	{
+	}
+
+	// Few neighbours and a small radius to fit the Pokitto's budget
+	static constexpr FlockSettings devicePreset(void)
+	{
+		return FlockSettings(1.5, 1.0, 1.0, 16, 6, 2, 0.125, 6);
+	}
+
+	static constexpr FlockSettings hostPreset(void)
+	{
+		return FlockSettings(1.5, 1.0, 1.0, 24, 8, 2, 0.125, 16);
+	}
+};
+
+//
+// Separation, alignment and cohesion steering for a swarm of bodies
+//
+// Neighbours are found through a UniformGrid, which must have been
+// rebuilt from the same bodies beforehand.
+// Steering for every body is worked out before any velocity changes,
+// so the result doesn't depend on the order of the bodies.
+//
+template< size_t CapacityValue >
+class Flock
+{
+public:
+	static constexpr size_t Capacity = CapacityValue;
+
+private:
+	// Fields
+	Vector2 steering[Capacity];
+
+public:
+	template< typename Grid, size_t size >
+	void update(const Grid & grid, RigidBody (&bodies)[size], const FlockSettings & settings)
+	{
+		static_assert(size <= Capacity, "Flock is too small for the body array");
+
+		for(size_t i = 0; i < size; ++i)
+			this->steering[i] = getSteering(grid, bodies, static_cast<typename Grid::IndexType>(i), settings);
+
+		for(size_t i = 0; i < size; ++i)
+		{
+			RigidBody & body = bodies[i];
+			body.velocity += this->steering[i];
+			body.velocity = limit(body.velocity, settings.maximumSpeed);
+		}
+	}
+
+private:
+	// Shortens the vector to maximum if it's any longer
+	static Vector2 limit(Vector2 vector, Number maximum)
+	{
+		return (vector.getMagnitudeFast() > maximum) ? (vector.getNormalisedFast() * maximum) : vector;
+	}
+
+	// Steering needed to turn velocity into the given heading at full speed
+	static Vector2 steerTowards(Vector2 heading, Vector2 velocity, const FlockSettings & settings)
+	{
+		if(heading == Vector2(Number(0), Number(0)))
+			return heading;
+
+		return limit(((heading.getNormalisedFast() * settings.maximumSpeed) - velocity), settings.maximumSteering);
+	}
+
+	template< typename Grid, size_t size >
+	static Vector2 getSteering(const Grid & grid, const RigidBody (&bodies)[size], typename Grid::IndexType index, const FlockSettings & settings)
+	{
+		using IndexType = typename Grid::IndexType;
+
+		const RigidBody & body = bodies[index];
+
+		const WideNumber neighbourRadiusSquared = multiply(settings.neighbourRadius, settings.neighbourRadius);
+		const WideNumber separationRadiusSquared = multiply(settings.separationRadius, settings.separationRadius);
+
+		const uint8_t left = grid.getColumn(body.position.x - settings.neighbourRadius);
+		const uint8_t right = grid.getColumn(body.position.x + settings.neighbourRadius);
+		const uint8_t top = grid.getRow(body.position.y - settings.neighbourRadius);
+		const uint8_t bottom = grid.getRow(body.position.y + settings.neighbourRadius);
+
+		Vector2 separation = Vector2(Number(0), Number(0));
+		Vector2 alignment = Vector2(Number(0), Number(0));
+		Vector2 offsetSum = Vector2(Number(0), Number(0));
+		uint8_t neighbours = 0;
+
+		for(uint8_t row = top; (row <= bottom) && (neighbours < settings.maximumNeighbours); ++row)
+			for(uint8_t column = left; (column <= right) && (neighbours < settings.maximumNeighbours); ++column)
+				for(IndexType other = grid.getCellHead(column, row); (other != Grid::None) && (neighbours < settings.maximumNeighbours); other = grid.getNext(other))
+				{
+					if(other == index)
+						continue;
+
+					const Vector2 offset = (bodies[other].position - body.position);
+					const WideNumber distanceSquared = offset.getMagnitudeSquaredWide();
+
+					if(distanceSquared > neighbourRadiusSquared)
+						continue;
+
+					++neighbours;
+
+					alignment += bodies[other].velocity;
+
+					// Summing offsets rather than positions keeps the total small
+					offsetSum += offset;
+
+					if(distanceSquared < separationRadiusSquared)
+						separation -= offset.getNormalisedFast();
+				}
+
+		if(neighbours == 0)
+			return Vector2(Number(0), Number(0));
+
+		// The direction of an average doesn't depend on the divide,
+		// so the sums can be steered towards as they are
+		Vector2 result = Vector2(Number(0), Number(0));
+		result += (steerTowards(separation, body.velocity, settings) * settings.separationWeight);
+		result += (steerTowards(alignment, body.velocity, settings) * settings.alignmentWeight);
+		result += (steerTowards(offsetSum, body.velocity, settings) * settings.cohesionWeight);
+		return result;
+	}
+};
+
+template< size_t CapacityValue >
+constexpr size_t Flock<CapacityValue>::Capacity;
@@ -0,0 +1,309 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "RigidBody.h"
+#include "Forces.h"
+
+enum class ForceSourceType : uint8_t
+{
+	None,
+	// Pulls towards position, falling off with the square of distance
+	// A negative strength pushes away instead
+	Attractor,
+	// Pushes along direction, strength is ignored
+	Wind,
+};
+
+class ForceSource
+{
+public:
+	// Fields
+	ForceSourceType type = ForceSourceType::None;
+	Point2 position;
+	Vector2 direction;
+	Number strength;
+
+	// Nothing outside this distance is affected
+	Number radius;
+
+public:
+	// Constructors
+	constexpr ForceSource(void) = default;
+
+	static constexpr ForceSource attractor(Point2 position, Number strength, Number radius)
+	{
+		return ForceSource(ForceSourceType::Attractor, position, Vector2(Number(0), Number(0)), strength, radius);
+	}
+
+	static constexpr ForceSource wind(Point2 position, Vector2 direction, Number radius)
+	{
+		return ForceSource(ForceSourceType::Wind, position, direction, Number(0), radius);
+	}
+
+	// The force this source exerts at point
+	Vector2 evaluate(Point2 point) const
+	{
+		const Vector2 offset = (this->position - point);
+
+		if(offset.getMagnitudeSquaredWide() > multiply(this->radius, this->radius))
+			return Vector2(Number(0), Number(0));
+
+		switch(this->type)
+		{
+			case ForceSourceType::Attractor:
+				return getInverseSquarePull(offset, this->strength, 1);
+
+			case ForceSourceType::Wind:
+				return this->direction;
+
+			default:
+				return Vector2(Number(0), Number(0));
+		}
+	}
+
+private:
+	constexpr ForceSource(ForceSourceType type, Point2 position, Vector2 direction, Number strength, Number radius)
+		: type(type), position(position), direction(direction), strength(strength), radius(radius)
+	{
+	}
+};
+
+//
+// A coarse grid of precomputed force vectors
+//
+// Sources are baked into the grid so that a body only needs
+// a bilinear lookup instead of a distance and division per source.
+//
+// When a source changes, only the grid points within its radius are
+// touched: its old contribution is taken off and the new one added.
+// Fixed point addition is exact, so this never drifts.
+//
+template< uint8_t ColumnsValue, uint8_t RowsValue, uint8_t SourceCapacityValue >
+class ForceField
+{
+public:
+	// The number of sample points across and down
+	static constexpr uint8_t Columns = ColumnsValue;
+	static constexpr uint8_t Rows = RowsValue;
+	static constexpr uint8_t SourceCapacity = SourceCapacityValue;
+
+	static constexpr uint8_t None = 0xFF;
+
+	static_assert(Columns >= 2, "ForceField needs at least two columns to interpolate between");
+	static_assert(Rows >= 2, "ForceField needs at least two rows to interpolate between");
+	static_assert(SourceCapacity < None, "ForceField source capacity is too large");
+
+private:
+	// Fields
+	Vector2 samples[Columns * Rows];
+
+	// What each source looks like now
+	ForceSource sources[SourceCapacity];
+
+	// What each source looked like when it was last baked
+	ForceSource bakedSources[SourceCapacity];
+
+	bool dirty[SourceCapacity];
+
+	uint8_t cellShift = 4;
+
+public:
+	// Constructors
+	ForceField(void)
+	{
+		this->clear();
+	}
+
+	ForceField(uint8_t cellShift) : cellShift(cellShift)
+	{
+		this->clear();
+	}
+
+	constexpr uint8_t getCellShift(void) const
+	{
+		return this->cellShift;
+	}
+
+	// Removes every source and zeroes the grid
+	void clear(void)
+	{
+		for(size_t i = 0; i < (Columns * Rows); ++i)
+			this->samples[i] = Vector2(Number(0), Number(0));
+
+		for(uint8_t i = 0; i < SourceCapacity; ++i)
+		{
+			this->sources[i] = ForceSource();
+			this->bakedSources[i] = ForceSource();
+			this->dirty[i] = false;
+		}
+	}
+
+	// Returns the new source's index, or None if there's no room
+	uint8_t addSource(const ForceSource & source)
+	{
+		for(uint8_t i = 0; i < SourceCapacity; ++i)
+			if(this->sources[i].type == ForceSourceType::None)
+			{
+				this->sources[i] = source;
+				this->dirty[i] = true;
+				return i;
+			}
+
+		return None;
+	}
+
+	const ForceSource & getSource(uint8_t index) const
+	{
+		return this->sources[index];
+	}
+
+	// Changes take effect on the next call to update
+	void setSource(uint8_t index, const ForceSource & source)
+	{
+		this->sources[index] = source;
+		this->dirty[index] = true;
+	}
+
+	void moveSource(uint8_t index, Point2 position)
+	{
+		if(this->sources[index].position == position)
+			return;
+
+		this->sources[index].position = position;
+		this->dirty[index] = true;
+	}
+
+	void removeSource(uint8_t index)
+	{
+		this->sources[index].type = ForceSourceType::None;
+		this->dirty[index] = true;
+	}
+
+	// Rebakes only the sources that have changed since the last update
+	void update(void)
+	{
+		for(uint8_t i = 0; i < SourceCapacity; ++i)
+		{
+			if(!this->dirty[i])
+				continue;
+
+			this->bake(this->bakedSources[i], false);
+			this->bake(this->sources[i], true);
+
+			this->bakedSources[i] = this->sources[i];
+			this->dirty[i] = false;
+		}
+	}
+
+	// Bilinear interpolation between the four surrounding samples
+	// Points outside the grid use the nearest edge
+	Vector2 sample(Point2 point) const
+	{
+		// Position in units of cells
+		const Number cellX = clampCell(Number::fromInternal(point.x.getInternal() >> this->cellShift), Columns);
+		const Number cellY = clampCell(Number::fromInternal(point.y.getInternal() >> this->cellShift), Rows);
+
+		const uint8_t column = static_cast<uint8_t>(cellX.getInteger());
+		const uint8_t row = static_cast<uint8_t>(cellY.getInteger());
+		const Number fractionX = Number::fromInternal(cellX.getFraction());
+		const Number fractionY = Number::fromInternal(cellY.getFraction());
+
+		const Vector2 topLeft = this->samples[getIndex(column, row)];
+		const Vector2 topRight = this->samples[getIndex(column + 1, row)];
+		const Vector2 bottomLeft = this->samples[getIndex(column, row + 1)];
+		const Vector2 bottomRight = this->samples[getIndex(column + 1, row + 1)];
+
+		const Vector2 top = (topLeft + ((topRight - topLeft) * fractionX));
+		const Vector2 bottom = (bottomLeft + ((bottomRight - bottomLeft) * fractionX));
+		return (top + ((bottom - top) * fractionY));
+	}
+
+	// Sums every source directly, the slow path that sample approximates
+	Vector2 evaluate(Point2 point) const
+	{
+		Vector2 result = Vector2(Number(0), Number(0));
+		for(uint8_t i = 0; i < SourceCapacity; ++i)
+			result += this->sources[i].evaluate(point);
+		return result;
+	}
+
+	template< size_t size >
+	void apply(RigidBody (&bodies)[size]) const
+	{
+		for(size_t i = 0; i < size; ++i)
+			bodies[i].applyForce(this->sample(bodies[i].position));
+	}
+
+private:
+	static constexpr size_t getIndex(uint8_t column, uint8_t row)
+	{
+		return ((row * Columns) + column);
+	}
+
+	// Keeps the cell coordinate where column and column + 1 are both valid
+	static Number clampCell(Number value, uint8_t count)
+	{
+		const Number maximum = Number::fromInternal((static_cast<int32_t>(count - 1) << Number::FractionSize) - 1);
+		return (value < 0) ? Number(0) : (value > maximum) ? maximum : value;
+	}
+
+	// Adds or removes a source's contribution to the grid points within its radius
+	void bake(const ForceSource & source, bool add)
+	{
+		if(source.type == ForceSourceType::None)
+			return;
+
+		const uint8_t left = this->getSampleIndex(source.position.x - source.radius, Columns);
+		const uint8_t right = this->getSampleIndex(source.position.x + source.radius + 1, Columns);
+		const uint8_t top = this->getSampleIndex(source.position.y - source.radius, Rows);
+		const uint8_t bottom = this->getSampleIndex(source.position.y + source.radius + 1, Rows);
+
+		for(uint8_t row = top; row <= bottom; ++row)
+			for(uint8_t column = left; column <= right; ++column)
+			{
+				const Point2 point = Point2(Number(static_cast<int32_t>(column) << this->cellShift), Number(static_cast<int32_t>(row) << this->cellShift));
+				const Vector2 force = source.evaluate(point);
+
+				if(add)
+					this->samples[getIndex(column, row)] += force;
+				else
+					this->samples[getIndex(column, row)] -= force;
+			}
+	}
+
+	uint8_t getSampleIndex(Number value, uint8_t count) const
+	{
+		const int32_t index = (value.getInternal() >> (Number::FractionSize + this->cellShift));
+		return (index < 0) ? 0 : (index >= count) ? (count - 1) : static_cast<uint8_t>(index);
+	}
+};
+
+template< uint8_t ColumnsValue, uint8_t RowsValue, uint8_t SourceCapacityValue >
+constexpr uint8_t ForceField<ColumnsValue, RowsValue, SourceCapacityValue>::Columns;
+
+template< uint8_t ColumnsValue, uint8_t RowsValue, uint8_t SourceCapacityValue >
+constexpr uint8_t ForceField<ColumnsValue, RowsValue, SourceCapacityValue>::Rows;
+
+template< uint8_t ColumnsValue, uint8_t RowsValue, uint8_t SourceCapacityValue >
+constexpr uint8_t ForceField<ColumnsValue, RowsValue, SourceCapacityValue>::SourceCapacity;
+
+template< uint8_t ColumnsValue, uint8_t RowsValue, uint8_t SourceCapacityValue >
+constexpr uint8_t ForceField<ColumnsValue, RowsValue, SourceCapacityValue>::None;
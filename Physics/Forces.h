@@ -0,0 +1,53 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Vector.h"
+
+// Pull of size strength / distance^2 along offset
+// softening keeps the pull finite as the distance approaches zero
+// Done on the internal values so the widened precision isn't lost
+inline Vector2 getInverseSquarePull(Vector2 offset, Number strength, Number softening)
+{
+	const WideNumber distanceSquared = (offset.getMagnitudeSquaredWide() + multiply(softening, softening));
+	const Number distance = squareRoot(distanceSquared);
+
+	if(distance <= 0)
+		return Vector2(Number(0), Number(0));
+
+	const int64_t numerator = (static_cast<int64_t>(strength.getInternal()) << 32);
+	const int64_t magnitudeInternal = (numerator / distanceSquared.getInternal());
+	const int32_t maximum = MaxNumber.getInternal();
+	const Number magnitude = Number::fromInternal(static_cast<int32_t>((magnitudeInternal > maximum) ? maximum : (magnitudeInternal < -maximum) ? -maximum : magnitudeInternal));
+
+	return Vector2((offset.x / distance) * magnitude, (offset.y / distance) * magnitude);
+}
+
+// As above, for a strength too big for a Number, like a whole cluster's mass
+inline Vector2 getInverseSquarePull(Vector2 offset, WideNumber strength, Number softening)
+{
+	const WideNumber distanceSquared = (offset.getMagnitudeSquaredWide() + multiply(softening, softening));
+	const Number distance = squareRoot(distanceSquared);
+
+	if(distance <= 0)
+		return Vector2(Number(0), Number(0));
+
+	const Number magnitude = divide(strength, distanceSquared);
+
+	return Vector2((offset.x / distance) * magnitude, (offset.y / distance) * magnitude);
+}
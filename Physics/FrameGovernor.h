@@ -0,0 +1,218 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "RigidBody.h"
+
+class FrameGovernorSettings
+{
+public:
+	// Fields
+
+	// Target time for a physics step, in whatever unit the caller measures
+	uint32_t budget = 10;
+
+	uint8_t minimumIterations = 1;
+	uint8_t maximumIterations = 8;
+
+	uint8_t minimumSubsteps = 1;
+	uint8_t maximumSubsteps = 4;
+
+	// Bodies slower than this fall asleep
+	// The low threshold is used at full quality, the high one at the lowest
+	Number lowSleepThreshold = 0.05;
+	Number highSleepThreshold = 0.5;
+
+	// Consecutive frames a body must stay under the threshold before it sleeps,
+	// so one slow frame at the top of a bounce doesn't freeze it in the air
+	// At most SleepState::MaxQuietFrames
+	uint8_t sleepFrames = 30;
+
+	// Bodies this close to the focus always get full quality
+	NumberU focusRadius = 48;
+
+	// Consecutive frames over budget before dropping a level,
+	// and comfortably under budget before raising one
+	uint8_t downgradeFrames = 2;
+	uint8_t upgradeFrames = 30;
+};
+
+//
+// Trades simulation quality for time when frames run long
+//
+// Feed it the time each physics step took. It keeps a running average,
+// drops the quality level when the average goes over budget, and only
+// raises it again once the average has stayed under three quarters of
+// the budget for a while. Between the two nothing changes, so the level
+// doesn't flicker.
+//
+// The quality level picks solver iterations, the substep limit and the
+// sleep threshold from between the bounds in the settings. Bodies near the
+// focus (usually the player or the camera) always get full quality.
+//
+template< uint8_t QualityLevelCountValue >
+class FrameGovernor
+{
+public:
+	static constexpr uint8_t QualityLevelCount = QualityLevelCountValue;
+	static constexpr uint8_t MaximumQualityLevel = (QualityLevelCount - 1);
+
+	static_assert(QualityLevelCount > 1, "A governor needs at least two quality levels");
+
+public:
+	// Fields
+	FrameGovernorSettings settings;
+
+private:
+	// In sixteenths, so small differences don't round away to nothing
+	uint32_t averageTime = 0;
+	uint8_t qualityLevel = MaximumQualityLevel;
+	uint8_t overBudgetFrames = 0;
+	uint8_t underBudgetFrames = 0;
+
+	Point2 focus = Point2(Number(0), Number(0));
+
+public:
+	// Constructors
+	FrameGovernor(void) = default;
+	FrameGovernor(const FrameGovernorSettings & settings) : settings(settings) {}
+
+	constexpr uint8_t getQualityLevel(void) const
+	{
+		return this->qualityLevel;
+	}
+
+	constexpr uint32_t getAverageTime(void) const
+	{
+		return (this->averageTime / 16);
+	}
+
+	void setFocus(Point2 focus)
+	{
+		this->focus = focus;
+	}
+
+	// Call once per frame with how long the physics step took
+	void update(uint32_t stepTime)
+	{
+		// Running average, each new frame counting for a quarter
+		const uint32_t time = (stepTime * 16);
+		this->averageTime = (time >= this->averageTime) ?
+			(this->averageTime + ((time - this->averageTime) / 4)) :
+			(this->averageTime - ((this->averageTime - time) / 4));
+
+		const uint32_t budget = (this->settings.budget * 16);
+
+		if(this->averageTime > budget)
+		{
+			this->underBudgetFrames = 0;
+
+			if(this->overBudgetFrames < UINT8_MAX)
+				++this->overBudgetFrames;
+
+			if((this->overBudgetFrames >= this->settings.downgradeFrames) && (this->qualityLevel > 0))
+			{
+				--this->qualityLevel;
+				this->overBudgetFrames = 0;
+			}
+		}
+		else if(this->averageTime < ((budget * 3) / 4))
+		{
+			this->overBudgetFrames = 0;
+
+			if(this->underBudgetFrames < UINT8_MAX)
+				++this->underBudgetFrames;
+
+			if((this->underBudgetFrames >= this->settings.upgradeFrames) && (this->qualityLevel < MaximumQualityLevel))
+			{
+				++this->qualityLevel;
+				this->underBudgetFrames = 0;
+			}
+		}
+		else
+		{
+			this->overBudgetFrames = 0;
+			this->underBudgetFrames = 0;
+		}
+	}
+
+	uint8_t getSolverIterations(void) const
+	{
+		return interpolate(this->settings.minimumIterations, this->settings.maximumIterations, this->qualityLevel);
+	}
+
+	uint8_t getSubstepLimit(void) const
+	{
+		return interpolate(this->settings.minimumSubsteps, this->settings.maximumSubsteps, this->qualityLevel);
+	}
+
+	Number getSleepThreshold(void) const
+	{
+		const Number range = (this->settings.highSleepThreshold - this->settings.lowSleepThreshold);
+		return (this->settings.highSleepThreshold - ((range * this->qualityLevel) / MaximumQualityLevel));
+	}
+
+	bool isNearFocus(Point2 position) const
+	{
+		const Number radius = fromUnsigned(this->settings.focusRadius);
+		return (distanceSquaredWide(position, this->focus) <= multiply(radius, radius));
+	}
+
+	uint8_t getSolverIterations(Point2 position) const
+	{
+		return this->isNearFocus(position) ? this->settings.maximumIterations : this->getSolverIterations();
+	}
+
+	Number getSleepThreshold(Point2 position) const
+	{
+		return this->isNearFocus(position) ? this->settings.lowSleepThreshold : this->getSleepThreshold();
+	}
+
+	// Puts the body to sleep once it's been slower than the threshold for where it is
+	// for settings.sleepFrames frames in a row, and wakes it once something has sped it up again
+	// Contacts should call state.wake(), which starts the count over
+	void updateSleeping(const RigidBody & body, SleepState & state) const
+	{
+		const Number threshold = this->getSleepThreshold(body.position);
+
+		if(body.velocity.getMagnitudeSquaredWide() >= multiply(threshold, threshold))
+		{
+			state.wake();
+			return;
+		}
+
+		state.addQuietFrame();
+
+		if(state.getQuietFrames() >= this->settings.sleepFrames)
+			state.sleep();
+	}
+
+private:
+	static uint8_t interpolate(uint8_t minimum, uint8_t maximum, uint8_t level)
+	{
+		return static_cast<uint8_t>(minimum + (((maximum - minimum) * level) / MaximumQualityLevel));
+	}
+};
+
+template< uint8_t QualityLevelCountValue >
+constexpr uint8_t FrameGovernor<QualityLevelCountValue>::QualityLevelCount;
+
+template< uint8_t QualityLevelCountValue >
+constexpr uint8_t FrameGovernor<QualityLevelCountValue>::MaximumQualityLevel;
@@ -0,0 +1,193 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "RigidBody.h"
+
+class GridTunerStats
+{
+public:
+	// Fields
+
+	// Cell shift in use, and the best one found by the last evaluation
+	uint8_t currentShift = 0;
+	uint8_t bestShift = 0;
+
+	// Estimated work per frame at those shifts, in the tuner's cost units
+	uint32_t currentCost = 0;
+	uint32_t bestCost = 0;
+
+	// Windows evaluated, and how many of them changed the cell size
+	uint16_t evaluationCount = 0;
+	uint16_t retuneCount = 0;
+};
+
+//
+// Picks a grid cell size to suit the bodies in play
+//
+// Each frame the game reports how many bodies there were, the largest
+// distance a body looks for neighbours, and how many candidate pairs the
+// grid produced. Every WindowFrames frames the tuner estimates the cost of
+// each cell size from those averages:
+//
+//   cells visited per body:      k * k, where k = ceil(2 * range / size) + 1
+//   candidate pairs per frame:   scaled from the measured pairs by the searched area
+//
+// If some size is cheaper than the current one by more than the threshold,
+// the grid is switched over and rebuilt. All of this happens in apply,
+// which should be called at the frame boundary, so the grid never changes mid-step.
+//
+template< uint8_t WindowFramesValue >
+class GridTuner
+{
+public:
+	static constexpr uint8_t WindowFrames = WindowFramesValue;
+
+	static_assert(WindowFrames > 0, "The window must cover at least one frame");
+
+public:
+	// Fields
+
+	// Relative cost of visiting a cell and of testing a candidate pair
+	uint8_t cellCost = 1;
+	uint8_t pairCost = 4;
+
+	// A new size must be at least this many sixteenths cheaper to be chosen
+	uint8_t threshold = 3;
+
+	// The smallest shift must still let the grid cover the play area
+	uint8_t minimumShift = 3;
+	uint8_t maximumShift = 7;
+
+private:
+	uint32_t bodySum = 0;
+	uint32_t pairSum = 0;
+	uint16_t rangeMaximum = 0;
+	uint16_t frameCount = 0;
+
+	GridTunerStats stats;
+
+public:
+	const GridTunerStats & getStats(void) const
+	{
+		return this->stats;
+	}
+
+	// Call once per frame, after the narrow phase
+	// range is the furthest any body looks for neighbours, in pixels
+	void record(uint16_t bodyCount, NumberU range, uint16_t candidatePairs)
+	{
+		this->bodySum += bodyCount;
+		this->pairSum += candidatePairs;
+
+		const uint16_t pixels = static_cast<uint16_t>(ceilFixed(range).getInteger());
+		if(pixels > this->rangeMaximum)
+			this->rangeMaximum = pixels;
+
+		if(this->frameCount < UINT16_MAX)
+			++this->frameCount;
+	}
+
+	// Call at a frame boundary
+	// Returns true if the cell size changed and the grid was rebuilt
+	template< typename Grid, size_t size >
+	bool apply(Grid & grid, const RigidBody (&bodies)[size])
+	{
+		this->stats.currentShift = grid.getCellShift();
+
+		if(this->frameCount < WindowFrames)
+			return false;
+
+		if(!this->evaluate())
+			return false;
+
+		grid.setCellShift(this->stats.bestShift);
+		grid.rebuild(bodies);
+
+		this->stats.currentShift = this->stats.bestShift;
+		++this->stats.retuneCount;
+		return true;
+	}
+
+private:
+	static constexpr uint32_t getCellsAcross(uint16_t range, uint8_t shift)
+	{
+		return (((static_cast<uint32_t>(range) * 2) + (1u << shift) - 1) >> shift) + 1;
+	}
+
+	uint32_t getCost(uint32_t bodies, uint32_t pairs, uint16_t range, uint8_t shift) const
+	{
+		const uint8_t currentShift = this->stats.currentShift;
+
+		const uint32_t cells = getCellsAcross(range, shift);
+		const uint32_t currentCells = getCellsAcross(range, currentShift);
+
+		// Side of the searched square, in pixels
+		const uint64_t side = (static_cast<uint64_t>(cells) << shift);
+		const uint64_t currentSide = (static_cast<uint64_t>(currentCells) << currentShift);
+
+		const uint64_t cellWork = (static_cast<uint64_t>(bodies) * cells * cells * this->cellCost);
+		const uint64_t pairWork = ((static_cast<uint64_t>(pairs) * side * side * this->pairCost) / (currentSide * currentSide));
+
+		const uint64_t total = (cellWork + pairWork);
+		return (total > UINT32_MAX) ? UINT32_MAX : static_cast<uint32_t>(total);
+	}
+
+	// Returns true if a better cell size was found
+	bool evaluate(void)
+	{
+		const uint32_t bodies = (this->bodySum / this->frameCount);
+		const uint32_t pairs = (this->pairSum / this->frameCount);
+		const uint16_t range = this->rangeMaximum;
+
+		this->bodySum = 0;
+		this->pairSum = 0;
+		this->rangeMaximum = 0;
+		this->frameCount = 0;
+
+		GridTunerStats & stats = this->stats;
+
+		stats.currentCost = this->getCost(bodies, pairs, range, stats.currentShift);
+		stats.bestShift = stats.currentShift;
+		stats.bestCost = stats.currentCost;
+
+		for(uint8_t shift = this->minimumShift; shift <= this->maximumShift; ++shift)
+		{
+			const uint32_t cost = this->getCost(bodies, pairs, range, shift);
+			if(cost < stats.bestCost)
+			{
+				stats.bestShift = shift;
+				stats.bestCost = cost;
+			}
+		}
+
+		++stats.evaluationCount;
+
+		// Only worth a rebuild if it's clearly cheaper
+		const uint64_t limit = ((static_cast<uint64_t>(stats.currentCost) * (16 - this->threshold)) / 16);
+		if((stats.bestShift != stats.currentShift) && (stats.bestCost <= limit))
+			return true;
+
+		stats.bestShift = stats.currentShift;
+		stats.bestCost = stats.currentCost;
+		return false;
+	}
+};
+
+template< uint8_t WindowFramesValue >
+constexpr uint8_t GridTuner<WindowFramesValue>::WindowFrames;
@@ -0,0 +1,281 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "Size.h"
+#include "Rectangle.h"
+#include "Circle.h"
+#include "Segment.h"
+#include "RigidBody.h"
+
+//
+// Ground described as one height per column, for side-scrolling levels
+//
+// Heights are the screen y of the ground surface, so smaller is higher.
+// Height and slope tables are only pointed to, so they can stay in flash.
+// Surface normals are worked out when the heightfield is created, and again
+// whenever updateNormals is called after the terrain changes. They're kept
+// as 1.15 fixed point, so each column costs four bytes of RAM.
+//
+// A body only looks up the columns it spans, so resolving it is O(width),
+// no matter how long the level is.
+//
+template< uint16_t ColumnsValue >
+class Heightfield
+{
+public:
+	static constexpr uint16_t Columns = ColumnsValue;
+
+private:
+	// Fields
+	const uint8_t * heights;
+
+	// Change in height across each column, in 1/16ths of a pixel per pixel
+	// nullptr means slopes are taken from the difference to the next column
+	const int8_t * slopes;
+
+	uint8_t columnShift;
+	Number restitution = 0.3;
+
+	// Unit surface normals as x and y, with 15 fraction bits
+	// A normal always points up, so y is in [-1, 0) and x in (-1, 1)
+	int16_t normals[Columns][2];
+
+public:
+	// Constructors
+	Heightfield(const uint8_t (&heights)[Columns], uint8_t columnShift = 0)
+		: heights(heights), slopes(nullptr), columnShift(columnShift)
+	{
+		this->updateNormals();
+	}
+
+	Heightfield(const uint8_t (&heights)[Columns], const int8_t (&slopes)[Columns], uint8_t columnShift = 0)
+		: heights(heights), slopes(slopes), columnShift(columnShift)
+	{
+		this->updateNormals();
+	}
+
+	constexpr Number getRestitution(void) const
+	{
+		return this->restitution;
+	}
+
+	void setRestitution(Number restitution)
+	{
+		this->restitution = restitution;
+	}
+
+	constexpr uint16_t getColumnWidth(void) const
+	{
+		return (1 << this->columnShift);
+	}
+
+	// Out of range x uses the nearest end column
+	uint16_t getColumn(Number x) const
+	{
+		const int32_t column = (x.getInternal() >> (Number::FractionSize + this->columnShift));
+		return (column < 0) ? 0 : (column >= Columns) ? (Columns - 1) : static_cast<uint16_t>(column);
+	}
+
+	// Change in y per pixel across the column
+	Number getSlope(uint16_t column) const
+	{
+		if(this->slopes != nullptr)
+			return (Number(this->slopes[column]) / 16);
+
+		if((column + 1) < Columns)
+			return (Number(static_cast<int16_t>(this->heights[column + 1] - this->heights[column])) / static_cast<int16_t>(1 << this->columnShift));
+
+		return 0;
+	}
+
+	Vector2 getNormal(uint16_t column) const
+	{
+		const int16_t * normal = this->normals[column];
+		return Vector2(Number::fromInternal(static_cast<int32_t>(normal[0]) * 2), Number::fromInternal(static_cast<int32_t>(normal[1]) * 2));
+	}
+
+	// Call after changing the heights or slopes the heightfield points to
+	void updateNormals(void)
+	{
+		for(uint16_t column = 0; column < Columns; ++column)
+		{
+			// y grows downwards, so the normal of a slope s points along (s, -1)
+			const Vector2 normal = Vector2(this->getSlope(column), Number(-1));
+			const Number length = normal.getMagnitude();
+
+			this->normals[column][0] = static_cast<int16_t>((normal.x / length).getInternal() / 2);
+			this->normals[column][1] = static_cast<int16_t>((normal.y / length).getInternal() / 2);
+		}
+	}
+
+	// The ground's y position directly below x
+	Number getSurfaceY(Number x) const
+	{
+		const uint16_t column = this->getColumn(x);
+		const Number left = Number(static_cast<int32_t>(column) << this->columnShift);
+		Number across = (x - left);
+
+		if(across < 0)
+			across = 0;
+
+		return (Number(this->heights[column]) + (this->getSlope(column) * across));
+	}
+
+	// Pushes a rectangle out of the ground and bounces its velocity
+	// Returns true if there was a collision
+	bool resolve(Rectangle & rectangle, Vector2 & velocity) const
+	{
+		const uint16_t first = this->getColumn(rectangle.getLeft());
+		const uint16_t last = this->getColumn(rectangle.getRight());
+
+		// The highest ground under the rectangle's bottom edge decides where it rests
+		Number highest = this->getSurfaceY(rectangle.getLeft());
+		uint16_t highestColumn = first;
+
+		for(uint16_t column = first; column <= last; ++column)
+		{
+			const Number left = Number(static_cast<int32_t>(column) << this->columnShift);
+			const Number right = (left + Number((1 << this->columnShift) - 1));
+
+			// Only the ends of the span inside the rectangle matter,
+			// since the surface is straight across a column
+			const Number start = (left > rectangle.getLeft()) ? left : rectangle.getLeft();
+			const Number end = (right < rectangle.getRight()) ? right : rectangle.getRight();
+			const Number surface = minimum(this->getSurfaceY(start), this->getSurfaceY(end));
+
+			if(surface < highest)
+			{
+				highest = surface;
+				highestColumn = column;
+			}
+		}
+
+		if(rectangle.getBottom() <= highest)
+			return false;
+
+		rectangle.position.y = (highest - fromUnsigned(rectangle.getHeight()));
+		this->bounce(velocity, this->getNormal(highestColumn));
+		return true;
+	}
+
+	// The ground's surface across a column, from its left edge to the next column's
+	Segment getSurface(uint16_t column) const
+	{
+		const Number width = Number(1 << this->columnShift);
+		const Number left = Number(static_cast<int32_t>(column) << this->columnShift);
+		const Number top = Number(this->heights[column]);
+
+		return Segment(left, top, (left + width), (top + (this->getSlope(column) * width)));
+	}
+
+	// Pushes a circle out of the ground, away from the closest surface point
+	// Returns true if there was a collision
+	bool resolve(Circle & circle, Vector2 & velocity) const
+	{
+		const Number radius = fromUnsigned(circle.radius);
+		const uint16_t first = this->getColumn(circle.getX() - radius);
+		const uint16_t last = this->getColumn(circle.getX() + radius);
+
+		Number deepest = 0;
+		Vector2 deepestDirection;
+
+		for(uint16_t column = first; column <= last; ++column)
+		{
+			const Segment surface = this->getSurface(column);
+			const Vector2 normal = this->getNormal(column);
+
+			const Number parameter = surface.getClosestParameter(circle.position);
+			const Point2 closest = (surface.start + (surface.getDirection() * parameter));
+			const Vector2 offset = (circle.position - closest);
+			const Number height = dot(offset, normal);
+
+			Number penetration;
+			Vector2 direction;
+
+			if(height > 0)
+			{
+				// Above the surface, so only the closest point can touch,
+				// which may be a corner rather than somewhere along the line
+				const Number distance = offset.getMagnitude();
+				penetration = (radius - distance);
+				direction = (distance > 0) ? Vector2((offset.x / distance), (offset.y / distance)) : normal;
+			}
+			else
+			{
+				// Beside a column's end and under its line means the centre is
+				// next to a step rather than under this column, so a neighbour
+				// column decides how far out it goes
+				if((parameter <= 0) || (parameter >= 1))
+					continue;
+
+				penetration = (radius - height);
+				direction = normal;
+			}
+
+			if(penetration > deepest)
+			{
+				deepest = penetration;
+				deepestDirection = direction;
+			}
+		}
+
+		if(deepest <= 0)
+			return false;
+
+		circle.position += (deepestDirection * deepest);
+		this->bounce(velocity, deepestDirection);
+		return true;
+	}
+
+	// Treats each body as a box of the given size with its position at the top left
+	template< size_t count >
+	void resolve(RigidBody (&bodies)[count], Size2 size) const
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			RigidBody & body = bodies[i];
+			Rectangle bounds = Rectangle(body.position, size);
+
+			if(this->resolve(bounds, body.velocity))
+				body.position = bounds.position;
+		}
+	}
+
+private:
+	static Number minimum(Number left, Number right)
+	{
+		return (left < right) ? left : right;
+	}
+
+	// Removes the velocity going into the ground and reflects it scaled by restitution
+	void bounce(Vector2 & velocity, Vector2 normal) const
+	{
+		const Number approach = dot(velocity, normal);
+
+		if(approach >= 0)
+			return;
+
+		velocity -= (normal * ((1 + this->restitution) * approach));
+	}
+};
+
+template< uint16_t ColumnsValue >
+constexpr uint16_t Heightfield<ColumnsValue>::Columns;
@@ -0,0 +1,279 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Size.h"
+#include "Rectangle.h"
+
+//
+// A grid with several levels of power-of-two cell sizes
+//
+// Each body goes in the smallest level whose cells are at least as big as
+// the body, in the cell holding its centre, so it overhangs that cell by at
+// most half a cell. Anything still too big for the top level goes there anyway,
+// and the grid keeps track of how far those bodies overhang.
+// Pairs are found by each body looking through the cells its bounds cover,
+// widened by that overhang, on its own level and every coarser one.
+//
+// All levels share one spatial hash, so empty cells cost nothing.
+// Each entry remembers its exact cell, so hash collisions are filtered out.
+//
+// BucketCount must be a power of two
+//
+template< uint8_t LevelCountValue, size_t CapacityValue, size_t BucketCountValue >
+class HierarchicalGrid
+{
+public:
+	static constexpr uint8_t LevelCount = LevelCountValue;
+	static constexpr size_t Capacity = CapacityValue;
+	static constexpr size_t BucketCount = BucketCountValue;
+
+	using IndexType = uint16_t;
+	static constexpr IndexType None = 0xFFFF;
+
+	static_assert(LevelCount <= 8, "Level occupancy is kept in 8 bits");
+	static_assert(Capacity < None, "HierarchicalGrid capacity is too large for its index type");
+	static_assert((BucketCount & (BucketCount - 1)) == 0, "BucketCount must be a power of two");
+
+private:
+	class Entry
+	{
+	public:
+		Rectangle bounds;
+		int16_t column;
+		int16_t row;
+		uint8_t level;
+		IndexType next;
+	};
+
+private:
+	// Fields
+	IndexType bucketHeads[BucketCount];
+	Entry entries[Capacity];
+
+	// Bit n is set if anything is in level n
+	uint8_t occupiedLevels = 0;
+
+	// Level 0 cells are (1 << baseShift) pixels square
+	uint8_t baseShift = 2;
+
+	// Half the size of the biggest body in the top level
+	Number topOverhang = 0;
+
+public:
+	// Constructors
+	HierarchicalGrid(void)
+	{
+		this->clear();
+	}
+
+	HierarchicalGrid(uint8_t baseShift) : baseShift(baseShift)
+	{
+		this->clear();
+	}
+
+	constexpr uint8_t getBaseShift(void) const
+	{
+		return this->baseShift;
+	}
+
+	// Changing the cell size invalidates the contents
+	void setBaseShift(uint8_t baseShift)
+	{
+		this->baseShift = baseShift;
+		this->clear();
+	}
+
+	constexpr uint8_t getOccupiedLevels(void) const
+	{
+		return this->occupiedLevels;
+	}
+
+	// The smallest level whose cells can hold something this big
+	// Anything too big for the top level goes in the top level anyway
+	uint8_t getLevel(Size2 size) const
+	{
+		const NumberU extent = (size.width > size.height) ? size.width : size.height;
+
+		uint8_t level = 0;
+		while(((level + 1) < LevelCount) && (extent > NumberU(1 << (this->baseShift + level))))
+			++level;
+
+		return level;
+	}
+
+	void clear(void)
+	{
+		for(size_t i = 0; i < BucketCount; ++i)
+			this->bucketHeads[i] = None;
+
+		this->occupiedLevels = 0;
+		this->topOverhang = 0;
+	}
+
+	void insert(IndexType index, Rectangle bounds)
+	{
+		Entry & entry = this->entries[index];
+
+		const uint8_t level = this->getLevel(bounds.getSize());
+		const uint8_t shift = (this->baseShift + level);
+		const Number centreX = (bounds.getX() + (fromUnsigned(bounds.getWidth()) / 2));
+		const Number centreY = (bounds.getY() + (fromUnsigned(bounds.getHeight()) / 2));
+
+		entry.bounds = bounds;
+		entry.level = level;
+		entry.column = getCell(centreX, shift);
+		entry.row = getCell(centreY, shift);
+
+		const size_t bucket = getBucket(entry.column, entry.row, level);
+		entry.next = this->bucketHeads[bucket];
+		this->bucketHeads[bucket] = index;
+
+		this->occupiedLevels |= (1 << level);
+
+		if(level == (LevelCount - 1))
+		{
+			const NumberU extent = (bounds.getWidth() > bounds.getHeight()) ? bounds.getWidth() : bounds.getHeight();
+			const Number overhang = fromUnsigned(extent / 2);
+
+			if(overhang > this->topOverhang)
+				this->topOverhang = overhang;
+		}
+	}
+
+	template< size_t size >
+	void rebuild(const Rectangle (&bounds)[size])
+	{
+		static_assert(size <= Capacity, "HierarchicalGrid is too small for the bounds array");
+
+		this->clear();
+		for(size_t i = 0; i < size; ++i)
+			this->insert(static_cast<IndexType>(i), bounds[i]);
+	}
+
+	// Calls action(index) for every body whose bounds overlap the area
+	template< typename Action >
+	void query(Rectangle area, Action action) const
+	{
+		for(uint8_t level = 0; level < LevelCount; ++level)
+		{
+			if((this->occupiedLevels & (1 << level)) == 0)
+				continue;
+
+			this->forEachNear(area, level, [&](IndexType index)
+			{
+				if(::intersects(area, this->entries[index].bounds))
+					action(index);
+			});
+		}
+	}
+
+	// Calls action(first, second) once for every pair of bodies whose bounds overlap
+	// Each body looks at its own level and the coarser ones,
+	// so every pair is found from its smaller body, or from both on the same level
+	template< typename Action >
+	void forEachPair(Action action) const
+	{
+		for(size_t bucket = 0; bucket < BucketCount; ++bucket)
+			for(IndexType index = this->bucketHeads[bucket]; index != None; index = this->entries[index].next)
+			{
+				const Entry & entry = this->entries[index];
+
+				for(uint8_t level = entry.level; level < LevelCount; ++level)
+				{
+					if((this->occupiedLevels & (1 << level)) == 0)
+						continue;
+
+					this->forEachNear(entry.bounds, level, [&](IndexType other)
+					{
+						// On the same level both bodies see each other
+						if((level == entry.level) && (other <= index))
+							return;
+
+						if(::intersects(entry.bounds, this->entries[other].bounds))
+							action(index, other);
+					});
+				}
+			}
+	}
+
+private:
+	static int16_t getCell(Number value, uint8_t shift)
+	{
+		return static_cast<int16_t>(value.getInternal() >> (Number::FractionSize + shift));
+	}
+
+	static size_t getBucket(int16_t column, int16_t row, uint8_t level)
+	{
+		const uint32_t hash =
+			(static_cast<uint32_t>(column) * UINT32_C(73856093)) ^
+			(static_cast<uint32_t>(row) * UINT32_C(19349663)) ^
+			(static_cast<uint32_t>(level) * UINT32_C(83492791));
+
+		return (hash & (BucketCount - 1));
+	}
+
+	// How far a body in the given level can reach outside its cell
+	Number getOverhang(uint8_t level) const
+	{
+		const Number halfCell = (Number(1 << (this->baseShift + level)) / 2);
+		return ((level == (LevelCount - 1)) && (this->topOverhang > halfCell)) ? this->topOverhang : halfCell;
+	}
+
+	// Calls function(index) for every body in the given level that could overlap the area,
+	// by looking in every cell the area covers once widened by the level's overhang
+	template< typename Function >
+	void forEachNear(Rectangle area, uint8_t level, Function function) const
+	{
+		const uint8_t shift = (this->baseShift + level);
+		const Number margin = this->getOverhang(level);
+		const int16_t left = getCell(area.getLeft() - margin, shift);
+		const int16_t right = getCell(area.getRight() + margin, shift);
+		const int16_t top = getCell(area.getTop() - margin, shift);
+		const int16_t bottom = getCell(area.getBottom() + margin, shift);
+
+		for(int16_t row = top; row <= bottom; ++row)
+			for(int16_t column = left; column <= right; ++column)
+				this->forEachInCell(column, row, level, function);
+	}
+
+	template< typename Function >
+	void forEachInCell(int16_t column, int16_t row, uint8_t level, Function function) const
+	{
+		for(IndexType index = this->bucketHeads[getBucket(column, row, level)]; index != None; index = this->entries[index].next)
+		{
+			const Entry & entry = this->entries[index];
+
+			if((entry.column == column) && (entry.row == row) && (entry.level == level))
+				function(index);
+		}
+	}
+};
+
+template< uint8_t LevelCountValue, size_t CapacityValue, size_t BucketCountValue >
+constexpr uint8_t HierarchicalGrid<LevelCountValue, CapacityValue, BucketCountValue>::LevelCount;
+
+template< uint8_t LevelCountValue, size_t CapacityValue, size_t BucketCountValue >
+constexpr size_t HierarchicalGrid<LevelCountValue, CapacityValue, BucketCountValue>::Capacity;
+
+template< uint8_t LevelCountValue, size_t CapacityValue, size_t BucketCountValue >
+constexpr size_t HierarchicalGrid<LevelCountValue, CapacityValue, BucketCountValue>::BucketCount;
+
+template< uint8_t LevelCountValue, size_t CapacityValue, size_t BucketCountValue >
+constexpr typename HierarchicalGrid<LevelCountValue, CapacityValue, BucketCountValue>::IndexType HierarchicalGrid<LevelCountValue, CapacityValue, BucketCountValue>::None;
@@ -0,0 +1,66 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Vector.h"
+#include "RigidBody.h"
+
+//
+// Integrators are policies: anything stepping a body through time
+// (the game loop, trajectory prediction) takes one as a template
+// parameter so they all agree on how a step works.
+//
+// A step is split in two so that collision handling can sit
+// between the velocity update and the position update.
+//
+
+// Semi-implicit Euler: update the velocity, then move by the new velocity
+class SemiImplicitEulerIntegrator
+{
+public:
+	// Adds acceleration, then scales each axis by its damping factor
+	static void integrateVelocity(RigidBody & body, Vector2 acceleration, Vector2 damping)
+	{
+		body.velocity += acceleration;
+		body.velocity.x *= damping.x;
+		body.velocity.y *= damping.y;
+	}
+
+	static void integratePosition(RigidBody & body)
+	{
+		body.position += body.velocity;
+	}
+
+	// A coarse step standing in for tickCount ordinary ones,
+	// for bodies that aren't stepped every tick
+	static void integrateVelocity(RigidBody & body, Vector2 acceleration, Vector2 damping, uint8_t tickCount)
+	{
+		body.velocity += (acceleration * Number(tickCount));
+
+		for(uint8_t tick = 0; tick < tickCount; ++tick)
+		{
+			body.velocity.x *= damping.x;
+			body.velocity.y *= damping.y;
+		}
+	}
+
+	static void integratePosition(RigidBody & body, uint8_t tickCount)
+	{
+		body.position += (body.velocity * Number(tickCount));
+	}
+};
@@ -0,0 +1,473 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "Circle.h"
+#include "Rectangle.h"
+#include "Segment.h"
+#include "Capsule.h"
+
+//
+// Tests between different kinds of shape
+//
+// Everything is compared as square distances in WideNumber,
+// so no square roots are needed until a contact is asked for.
+//
+
+inline WideNumber getRadiusSquaredWide(NumberU radius)
+{
+	return multiply(fromUnsigned(radius), fromUnsigned(radius));
+}
+
+// Twice the signed area of the triangle, positive if clockwise on screen
+inline constexpr WideNumber getOrientation(Point2 first, Point2 second, Point2 third)
+{
+	return crossWide(second - first, third - first);
+}
+
+//
+// Point
+//
+
+// The point of a rectangle nearest to a point, the point itself if inside
+inline Point2 getClosestPoint(Point2 point, Rectangle rectangle)
+{
+	return Point2(clamp(point.x, rectangle.getLeft(), rectangle.getRight()), clamp(point.y, rectangle.getTop(), rectangle.getBottom()));
+}
+
+// Square distance from a point to the nearest point of a rectangle, zero if inside
+inline WideNumber getDistanceSquared(Point2 point, Rectangle rectangle)
+{
+	return distanceSquaredWide(point, getClosestPoint(point, rectangle));
+}
+
+//
+// Circle & Rectangle
+//
+
+inline bool intersects(Circle circle, Rectangle rectangle)
+{
+	return (getDistanceSquared(circle.position, rectangle) <= getRadiusSquaredWide(circle.radius));
+}
+
+inline bool intersects(Rectangle rectangle, Circle circle)
+{
+	return intersects(circle, rectangle);
+}
+
+//
+// Segment
+//
+
+inline bool intersects(Segment segment, Circle circle)
+{
+	return (segment.getDistanceSquared(circle.position) <= getRadiusSquaredWide(circle.radius));
+}
+
+inline bool intersects(Circle circle, Segment segment)
+{
+	return intersects(segment, circle);
+}
+
+inline bool intersects(Segment first, Segment second)
+{
+	const WideNumber first1 = getOrientation(second.start, second.end, first.start);
+	const WideNumber first2 = getOrientation(second.start, second.end, first.end);
+	const WideNumber second1 = getOrientation(first.start, first.end, second.start);
+	const WideNumber second2 = getOrientation(first.start, first.end, second.end);
+
+	// Each segment's ends lie on opposite sides of the other
+	if((((first1 > 0) && (first2 < 0)) || ((first1 < 0) && (first2 > 0))) && (((second1 > 0) && (second2 < 0)) || ((second1 < 0) && (second2 > 0))))
+		return true;
+
+	// Touching or collinear, so it's down to whether an end lies on the other segment
+	return
+		((first1 == 0) && (second.getDistanceSquared(first.start) == 0)) ||
+		((first2 == 0) && (second.getDistanceSquared(first.end) == 0)) ||
+		((second1 == 0) && (first.getDistanceSquared(second.start) == 0)) ||
+		((second2 == 0) && (first.getDistanceSquared(second.end) == 0));
+}
+
+// Square distance between the closest points of two segments
+inline WideNumber getDistanceSquared(Segment first, Segment second)
+{
+	if(intersects(first, second))
+		return 0;
+
+	// If they don't cross, the closest points always include an end
+	WideNumber result = first.getDistanceSquared(second.start);
+
+	const WideNumber candidates[] =
+	{
+		first.getDistanceSquared(second.end),
+		second.getDistanceSquared(first.start),
+		second.getDistanceSquared(first.end),
+	};
+
+	for(size_t i = 0; i < arrayLength(candidates); ++i)
+		if(candidates[i] < result)
+			result = candidates[i];
+
+	return result;
+}
+
+inline bool intersects(Segment segment, Rectangle rectangle)
+{
+	if(rectangle.intersects(segment.start) || rectangle.intersects(segment.end))
+		return true;
+
+	const Point2 topLeft = Point2(rectangle.getLeft(), rectangle.getTop());
+	const Point2 topRight = Point2(rectangle.getRight(), rectangle.getTop());
+	const Point2 bottomLeft = Point2(rectangle.getLeft(), rectangle.getBottom());
+	const Point2 bottomRight = Point2(rectangle.getRight(), rectangle.getBottom());
+
+	return
+		intersects(segment, Segment(topLeft, topRight)) ||
+		intersects(segment, Segment(topRight, bottomRight)) ||
+		intersects(segment, Segment(bottomRight, bottomLeft)) ||
+		intersects(segment, Segment(bottomLeft, topLeft));
+}
+
+inline bool intersects(Rectangle rectangle, Segment segment)
+{
+	return intersects(segment, rectangle);
+}
+
+// Square distance between the closest points of a segment and a rectangle, zero if they overlap
+inline WideNumber getDistanceSquared(Segment segment, Rectangle rectangle)
+{
+	if(intersects(segment, rectangle))
+		return 0;
+
+	// Both shapes are convex, so the closest points include
+	// either an end of the segment or a corner of the rectangle
+	WideNumber result = getDistanceSquared(segment.start, rectangle);
+
+	const WideNumber candidates[] =
+	{
+		getDistanceSquared(segment.end, rectangle),
+		segment.getDistanceSquared(Point2(rectangle.getLeft(), rectangle.getTop())),
+		segment.getDistanceSquared(Point2(rectangle.getRight(), rectangle.getTop())),
+		segment.getDistanceSquared(Point2(rectangle.getLeft(), rectangle.getBottom())),
+		segment.getDistanceSquared(Point2(rectangle.getRight(), rectangle.getBottom())),
+	};
+
+	for(size_t i = 0; i < arrayLength(candidates); ++i)
+		if(candidates[i] < result)
+			result = candidates[i];
+
+	return result;
+}
+
+//
+// Capsule
+//
+
+inline bool intersects(Capsule capsule, Circle circle)
+{
+	return (capsule.segment.getDistanceSquared(circle.position) <= getRadiusSquaredWide(capsule.radius + circle.radius));
+}
+
+inline bool intersects(Circle circle, Capsule capsule)
+{
+	return intersects(capsule, circle);
+}
+
+inline bool intersects(Capsule capsule, Rectangle rectangle)
+{
+	return (getDistanceSquared(capsule.segment, rectangle) <= getRadiusSquaredWide(capsule.radius));
+}
+
+inline bool intersects(Rectangle rectangle, Capsule capsule)
+{
+	return intersects(capsule, rectangle);
+}
+
+inline bool intersects(Capsule capsule, Segment segment)
+{
+	return (getDistanceSquared(capsule.segment, segment) <= getRadiusSquaredWide(capsule.radius));
+}
+
+inline bool intersects(Segment segment, Capsule capsule)
+{
+	return intersects(capsule, segment);
+}
+
+inline bool intersects(Capsule first, Capsule second)
+{
+	return (getDistanceSquared(first.segment, second.segment) <= getRadiusSquaredWide(first.radius + second.radius));
+}
+
+//
+// Contacts
+//
+// Covered pairs are circle & circle, capsule & circle, capsule & capsule,
+// capsule & segment and capsule & rectangle. A segment can be treated as
+// a capsule with no radius, and a circle as one with no length.
+//
+
+class Contact
+{
+public:
+	// Fields
+
+	// Unit vector pointing from the first shape towards the second
+	Vector2 normal;
+
+	// How far the shapes overlap along the normal
+	Number depth;
+};
+
+// Contact between two round shapes, given their closest core points
+// Returns false if they don't touch
+inline bool getContact(Point2 first, NumberU firstRadius, Point2 second, NumberU secondRadius, Contact & contact)
+{
+	const Number radius = fromUnsigned(firstRadius + secondRadius);
+	const WideNumber distanceSquared = distanceSquaredWide(first, second);
+
+	if(distanceSquared > multiply(radius, radius))
+		return false;
+
+	// Only now is the square root worth paying for
+	const Number distance = squareRoot(distanceSquared);
+	const Vector2 offset = (second - first);
+
+	// Directly on top of each other, so any direction will do
+	contact.normal = (distance > 0) ? Vector2((offset.x / distance), (offset.y / distance)) : Vector2(Number(0), Number(-1));
+	contact.depth = (radius - distance);
+	return true;
+}
+
+inline bool getContact(Circle first, Circle second, Contact & contact)
+{
+	return getContact(first.position, first.radius, second.position, second.radius, contact);
+}
+
+inline bool getContact(Capsule capsule, Circle circle, Contact & contact)
+{
+	return getContact(capsule.segment.getClosestPoint(circle.position), capsule.radius, circle.position, circle.radius, contact);
+}
+
+// Narrows a contact down to the shallowest way out along an axis,
+// given where each shape starts and ends along it
+inline void separateAlong(Vector2 axis, Number firstMinimum, Number firstMaximum, Number secondMinimum, Number secondMaximum, Contact & contact)
+{
+	// Moving the second shape along the axis, or against it
+	const Number forwards = (firstMaximum - secondMinimum);
+	const Number backwards = (secondMaximum - firstMinimum);
+
+	if(forwards < contact.depth)
+	{
+		contact.depth = forwards;
+		contact.normal = axis;
+	}
+
+	if(backwards < contact.depth)
+	{
+		contact.depth = backwards;
+		contact.normal = Vector2(-axis.x, -axis.y);
+	}
+}
+
+// Unit vector at right angles to a segment, or zero if the segment is a point
+inline Vector2 getUnitNormal(Segment segment)
+{
+	const Vector2 normal = perpendicular(segment.getDirection());
+	const Number length = normal.getMagnitude();
+
+	return (length > 0) ? Vector2((normal.x / length), (normal.y / length)) : Vector2(Number(0), Number(0));
+}
+
+// Where a segment grown by radius starts and ends along an axis
+// Measuring from a nearby origin keeps the dot products from overflowing
+inline void project(Segment segment, Number radius, Point2 origin, Vector2 axis, Number & minimum, Number & maximum)
+{
+	const Number start = dot((segment.start - origin), axis);
+	const Number end = dot((segment.end - origin), axis);
+
+	minimum = (((start < end) ? start : end) - radius);
+	maximum = (((start > end) ? start : end) + radius);
+}
+
+inline void project(Rectangle rectangle, Point2 origin, Vector2 axis, Number & minimum, Number & maximum)
+{
+	const Point2 corners[] =
+	{
+		Point2(rectangle.getLeft(), rectangle.getTop()),
+		Point2(rectangle.getRight(), rectangle.getTop()),
+		Point2(rectangle.getLeft(), rectangle.getBottom()),
+		Point2(rectangle.getRight(), rectangle.getBottom()),
+	};
+
+	minimum = dot((corners[0] - origin), axis);
+	maximum = minimum;
+
+	for(size_t i = 1; i < arrayLength(corners); ++i)
+	{
+		const Number distance = dot((corners[i] - origin), axis);
+
+		if(distance < minimum)
+			minimum = distance;
+
+		if(distance > maximum)
+			maximum = distance;
+	}
+}
+
+// Core segments that cross have no single closest pair of points,
+// so the way out is the shallowest along either segment's normal
+inline void getCrossingContact(Capsule first, Capsule second, Contact & contact)
+{
+	const Point2 origin = first.segment.start;
+	const Vector2 axes[] = { getUnitNormal(first.segment), getUnitNormal(second.segment) };
+
+	contact.normal = Vector2(Number(0), Number(-1));
+	contact.depth = MaxNumber;
+
+	for(size_t i = 0; i < arrayLength(axes); ++i)
+	{
+		// A segment that's only a point has no normal to offer
+		if((axes[i].x == 0) && (axes[i].y == 0))
+			continue;
+
+		Number firstMinimum;
+		Number firstMaximum;
+		project(first.segment, fromUnsigned(first.radius), origin, axes[i], firstMinimum, firstMaximum);
+
+		Number secondMinimum;
+		Number secondMaximum;
+		project(second.segment, fromUnsigned(second.radius), origin, axes[i], secondMinimum, secondMaximum);
+
+		separateAlong(axes[i], firstMinimum, firstMaximum, secondMinimum, secondMaximum, contact);
+	}
+
+	// Both are points in the same place, so any direction will do
+	if(contact.depth == MaxNumber)
+		contact.depth = fromUnsigned(first.radius + second.radius);
+}
+
+inline bool getContact(Capsule first, Capsule second, Contact & contact)
+{
+	if(intersects(first.segment, second.segment))
+	{
+		getCrossingContact(first, second, contact);
+		return true;
+	}
+
+	// Find which end gives the closest pair of core points
+	Point2 firstPoint = first.segment.start;
+	Point2 secondPoint = second.segment.getClosestPoint(firstPoint);
+	WideNumber closest = distanceSquaredWide(firstPoint, secondPoint);
+
+	const Point2 candidates[][2] =
+	{
+		{ first.segment.end, second.segment.getClosestPoint(first.segment.end) },
+		{ first.segment.getClosestPoint(second.segment.start), second.segment.start },
+		{ first.segment.getClosestPoint(second.segment.end), second.segment.end },
+	};
+
+	for(size_t i = 0; i < arrayLength(candidates); ++i)
+	{
+		const WideNumber distance = distanceSquaredWide(candidates[i][0], candidates[i][1]);
+		if(distance < closest)
+		{
+			closest = distance;
+			firstPoint = candidates[i][0];
+			secondPoint = candidates[i][1];
+		}
+	}
+
+	return getContact(firstPoint, first.radius, secondPoint, second.radius, contact);
+}
+
+inline bool getContact(Capsule capsule, Segment segment, Contact & contact)
+{
+	return getContact(capsule, Capsule(segment, NumberU(0)), contact);
+}
+
+inline bool getContact(Capsule capsule, Rectangle rectangle, Contact & contact)
+{
+	const Segment segment = capsule.segment;
+
+	if(!intersects(segment, rectangle))
+	{
+		// Same candidates as getDistanceSquared, keeping the points this time
+		Point2 capsulePoint = segment.start;
+		Point2 rectanglePoint = getClosestPoint(segment.start, rectangle);
+		WideNumber closest = distanceSquaredWide(capsulePoint, rectanglePoint);
+
+		const Point2 corners[] =
+		{
+			Point2(rectangle.getLeft(), rectangle.getTop()),
+			Point2(rectangle.getRight(), rectangle.getTop()),
+			Point2(rectangle.getLeft(), rectangle.getBottom()),
+			Point2(rectangle.getRight(), rectangle.getBottom()),
+		};
+
+		const Point2 candidates[][2] =
+		{
+			{ segment.end, getClosestPoint(segment.end, rectangle) },
+			{ segment.getClosestPoint(corners[0]), corners[0] },
+			{ segment.getClosestPoint(corners[1]), corners[1] },
+			{ segment.getClosestPoint(corners[2]), corners[2] },
+			{ segment.getClosestPoint(corners[3]), corners[3] },
+		};
+
+		for(size_t i = 0; i < arrayLength(candidates); ++i)
+		{
+			const WideNumber distance = distanceSquaredWide(candidates[i][0], candidates[i][1]);
+			if(distance < closest)
+			{
+				closest = distance;
+				capsulePoint = candidates[i][0];
+				rectanglePoint = candidates[i][1];
+			}
+		}
+
+		return getContact(capsulePoint, capsule.radius, rectanglePoint, NumberU(0), contact);
+	}
+
+	// The core is inside the rectangle, so the way out is
+	// the shallowest along the rectangle's sides or the segment's normal
+	const Point2 origin = Point2(rectangle.getLeft(), rectangle.getTop());
+	const Number radius = fromUnsigned(capsule.radius);
+	const Vector2 axes[] = { Vector2(Number(1), Number(0)), Vector2(Number(0), Number(1)), getUnitNormal(segment) };
+
+	contact.normal = Vector2(Number(0), Number(-1));
+	contact.depth = MaxNumber;
+
+	for(size_t i = 0; i < arrayLength(axes); ++i)
+	{
+		if((axes[i].x == 0) && (axes[i].y == 0))
+			continue;
+
+		Number capsuleMinimum;
+		Number capsuleMaximum;
+		project(segment, radius, origin, axes[i], capsuleMinimum, capsuleMaximum);
+
+		Number rectangleMinimum;
+		Number rectangleMaximum;
+		project(rectangle, origin, axes[i], rectangleMinimum, rectangleMaximum);
+
+		separateAlong(axes[i], capsuleMinimum, capsuleMaximum, rectangleMinimum, rectangleMaximum, contact);
+	}
+
+	return true;
+}
@@ -0,0 +1,262 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "RigidBody.h"
+
+enum class DetailTier : uint8_t
+{
+	Near,
+	Middle,
+	Far,
+};
+
+enum class FarDetailMode : uint8_t
+{
+	// Far bodies don't move at all
+	Frozen,
+
+	// Far bodies coast along their velocity, with no forces or collisions
+	Integrated,
+};
+
+class DetailSettings
+{
+public:
+	// Fields
+
+	// Bodies within these distances of the camera, on both axes, are near or middle
+	Number nearDistance = 160;
+	Number middleDistance = 480;
+
+	// How many ticks apart middle and far bodies are stepped
+	// Both must be powers of two
+	uint8_t middleInterval = 2;
+	uint8_t farInterval = 8;
+
+	FarDetailMode farMode = FarDetailMode::Frozen;
+
+	// How many far bodies are checked each tick to see if they've come closer
+	uint8_t farChecksPerTick = 8;
+};
+
+//
+// Steps bodies less often the further they are from the camera
+//
+// Near bodies are stepped every tick. Middle bodies are stepped every
+// middleInterval ticks, with a step that long, spread out so the same number
+// are stepped each tick. Far bodies are frozen or only coast.
+//
+// Body indices are kept partitioned by tier, so far bodies cost nothing
+// on most ticks. Near and middle bodies are reclassified every tick; far
+// bodies are reclassified a few at a time in turn, so a body drifting into
+// range (or the camera scrolling onto it) is picked up within a few ticks.
+//
+template< size_t CapacityValue >
+class LevelOfDetail
+{
+public:
+	static constexpr size_t Capacity = CapacityValue;
+
+	using IndexType = uint16_t;
+
+	static_assert(Capacity <= 0x10000, "Capacity must fit a 16-bit index");
+
+public:
+	// Fields
+	DetailSettings settings;
+
+private:
+	// Body indices, near ones first, then middle, then far
+	IndexType order[Capacity];
+
+	// Where each body is in order
+	IndexType slots[Capacity];
+
+	DetailTier tiers[Capacity];
+
+	size_t count = 0;
+	size_t nearEnd = 0;
+	size_t middleEnd = 0;
+
+	size_t farCursor = 0;
+	uint32_t tick = 0;
+
+	Point2 camera = Point2(Number(0), Number(0));
+
+public:
+	constexpr DetailTier getTier(IndexType index) const
+	{
+		return this->tiers[index];
+	}
+
+	constexpr size_t getNearCount(void) const
+	{
+		return this->nearEnd;
+	}
+
+	constexpr size_t getMiddleCount(void) const
+	{
+		return (this->middleEnd - this->nearEnd);
+	}
+
+	constexpr size_t getFarCount(void) const
+	{
+		return (this->count - this->middleEnd);
+	}
+
+	void setCamera(Point2 camera)
+	{
+		this->camera = camera;
+	}
+
+	DetailTier classify(Point2 position) const
+	{
+		const Number distanceX = absFixed(position.x - this->camera.x);
+		const Number distanceY = absFixed(position.y - this->camera.y);
+		const Number distance = (distanceX > distanceY) ? distanceX : distanceY;
+
+		return
+			(distance <= this->settings.nearDistance) ? DetailTier::Near :
+			(distance <= this->settings.middleDistance) ? DetailTier::Middle :
+			DetailTier::Far;
+	}
+
+	// Classifies every body from scratch
+	template< size_t size >
+	void reset(const RigidBody (&bodies)[size])
+	{
+		static_assert(size <= Capacity, "LevelOfDetail is too small for the body array");
+
+		this->count = size;
+		this->nearEnd = size;
+		this->middleEnd = size;
+		this->farCursor = 0;
+
+		for(size_t i = 0; i < size; ++i)
+		{
+			this->order[i] = static_cast<IndexType>(i);
+			this->slots[i] = static_cast<IndexType>(i);
+			this->tiers[i] = DetailTier::Near;
+		}
+
+		for(size_t i = 0; i < size; ++i)
+			this->setTier(static_cast<IndexType>(i), this->classify(bodies[i].position));
+	}
+
+	// Calls stepBody(body, tickCount) for each body due a step this tick,
+	// tickCount being how many ticks the step should cover
+	template< typename Integrator, size_t size, typename StepFunction >
+	void step(RigidBody (&bodies)[size], StepFunction stepBody)
+	{
+		++this->tick;
+
+		for(size_t slot = 0; slot < this->nearEnd; ++slot)
+			stepBody(bodies[this->order[slot]], static_cast<uint8_t>(1));
+
+		const uint8_t middleInterval = this->settings.middleInterval;
+		for(size_t slot = this->nearEnd; slot < this->middleEnd; ++slot)
+		{
+			const IndexType index = this->order[slot];
+			if(((this->tick + index) & (middleInterval - 1)) == 0)
+				stepBody(bodies[index], middleInterval);
+		}
+
+		if(this->settings.farMode == FarDetailMode::Integrated)
+		{
+			const uint8_t farInterval = this->settings.farInterval;
+			for(size_t slot = this->middleEnd; slot < this->count; ++slot)
+			{
+				const IndexType index = this->order[slot];
+				if(((this->tick + index) & (farInterval - 1)) == 0)
+					Integrator::integratePosition(bodies[index], farInterval);
+			}
+		}
+
+		this->reclassify(bodies);
+	}
+
+private:
+	template< size_t size >
+	void reclassify(const RigidBody (&bodies)[size])
+	{
+		// Moving a body to a further tier swaps an unchecked body into its slot,
+		// so the slot is checked again
+		for(size_t slot = 0; slot < this->middleEnd;)
+		{
+			const IndexType index = this->order[slot];
+			const DetailTier tier = this->classify(bodies[index].position);
+			const bool isFurther = (tier > this->tiers[index]);
+
+			this->setTier(index, tier);
+
+			if(!isFurther)
+				++slot;
+		}
+
+		for(uint8_t check = 0; check < this->settings.farChecksPerTick; ++check)
+		{
+			const size_t farCount = this->getFarCount();
+			if(farCount == 0)
+				break;
+
+			if(this->farCursor >= farCount)
+				this->farCursor = 0;
+
+			const IndexType index = this->order[this->middleEnd + this->farCursor];
+			this->setTier(index, this->classify(bodies[index].position));
+
+			++this->farCursor;
+		}
+	}
+
+	void swapSlots(size_t first, size_t second)
+	{
+		const IndexType firstIndex = this->order[first];
+		const IndexType secondIndex = this->order[second];
+
+		this->order[first] = secondIndex;
+		this->order[second] = firstIndex;
+		this->slots[firstIndex] = static_cast<IndexType>(second);
+		this->slots[secondIndex] = static_cast<IndexType>(first);
+	}
+
+	// Moves a body one partition at a time until it's in the right tier
+	void setTier(IndexType index, DetailTier tier)
+	{
+		while(this->tiers[index] < tier)
+		{
+			size_t & end = (this->tiers[index] == DetailTier::Near) ? this->nearEnd : this->middleEnd;
+			--end;
+			this->swapSlots(this->slots[index], end);
+			this->tiers[index] = static_cast<DetailTier>(static_cast<uint8_t>(this->tiers[index]) + 1);
+		}
+
+		while(this->tiers[index] > tier)
+		{
+			size_t & end = (this->tiers[index] == DetailTier::Far) ? this->middleEnd : this->nearEnd;
+			this->swapSlots(this->slots[index], end);
+			++end;
+			this->tiers[index] = static_cast<DetailTier>(static_cast<uint8_t>(this->tiers[index]) - 1);
+		}
+	}
+};
+
+template< size_t CapacityValue >
+constexpr size_t LevelOfDetail<CapacityValue>::Capacity;
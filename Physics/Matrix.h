@@ -0,0 +1,107 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Vector.h"
+
+//
+// A 2x2 matrix of Numbers, for rotating and scaling vectors
+//
+// Products are summed in a WideNumber and rounded once per element,
+// so chaining matrices doesn't pile up rounding error
+//
+class Matrix2
+{
+public:
+	// Fields, by row then column
+	Number m00;
+	Number m01;
+	Number m10;
+	Number m11;
+
+public:
+	// Constructors
+	constexpr Matrix2(void) = default;
+	constexpr Matrix2(Number m00, Number m01, Number m10, Number m11) : m00(m00), m01(m01), m10(m10), m11(m11) {}
+
+	static constexpr Matrix2 identity(void)
+	{
+		return Matrix2(Number(1), Number(0), Number(0), Number(1));
+	}
+
+	// Rotation by the angle whose cosine and sine are given
+	// Anticlockwise on screen for a positive angle, since y points down
+	static constexpr Matrix2 rotation(Number cosine, Number sine)
+	{
+		return Matrix2(cosine, sine, -sine, cosine);
+	}
+
+	// Rotation taking (1, 0) to the given unit vector
+	static constexpr Matrix2 rotation(Vector2 direction)
+	{
+		return rotation(direction.x, -direction.y);
+	}
+
+	static constexpr Matrix2 scale(Number x, Number y)
+	{
+		return Matrix2(x, Number(0), Number(0), y);
+	}
+
+	constexpr Matrix2 getTransposed(void) const
+	{
+		return Matrix2(this->m00, this->m10, this->m01, this->m11);
+	}
+
+	constexpr WideNumber getDeterminantWide(void) const
+	{
+		return (multiply(this->m00, this->m11) - multiply(this->m01, this->m10));
+	}
+
+	constexpr Vector2 transform(Vector2 vector) const
+	{
+		return Vector2(
+			narrow(multiply(this->m00, vector.x) + multiply(this->m01, vector.y)),
+			narrow(multiply(this->m10, vector.x) + multiply(this->m11, vector.y)));
+	}
+};
+
+inline constexpr bool operator ==(const Matrix2 & left, const Matrix2 & right)
+{
+	return ((left.m00 == right.m00) && (left.m01 == right.m01) && (left.m10 == right.m10) && (left.m11 == right.m11));
+}
+
+inline constexpr bool operator !=(const Matrix2 & left, const Matrix2 & right)
+{
+	return !(left == right);
+}
+
+// Multiplying two matrices applies right first, then left
+inline constexpr Matrix2 operator *(const Matrix2 & left, const Matrix2 & right)
+{
+	return Matrix2(
+		narrow(multiply(left.m00, right.m00) + multiply(left.m01, right.m10)),
+		narrow(multiply(left.m00, right.m01) + multiply(left.m01, right.m11)),
+		narrow(multiply(left.m10, right.m00) + multiply(left.m11, right.m10)),
+		narrow(multiply(left.m10, right.m01) + multiply(left.m11, right.m11)));
+}
+
+// Multiplying a matrix by a vector transforms the vector
+inline constexpr Vector2 operator *(const Matrix2 & matrix, Vector2 vector)
+{
+	return matrix.transform(vector);
+}
@@ -0,0 +1,127 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "RigidBody.h"
+#include "RadixSort.h"
+
+constexpr uint16_t spreadBits(uint16_t value, uint8_t shift, uint16_t mask)
+{
+	return static_cast<uint16_t>((value | (value << shift)) & mask);
+}
+
+// Spreads the bits of value out so there's a zero between each one
+constexpr uint16_t spreadBits(uint8_t value)
+{
+	return spreadBits(spreadBits(spreadBits(value, 4, 0x0F0F), 2, 0x3333), 1, 0x5555);
+}
+
+// Interleaves the bits of column and row to give a Z-order curve,
+// so cells that are close together usually get codes that are close together
+constexpr uint16_t getMortonCode(uint8_t column, uint8_t row)
+{
+	return static_cast<uint16_t>(spreadBits(column) | (spreadBits(row) << 1));
+}
+
+//
+// Sorts bodies by the Z-order of their grid cell
+//
+// As bodies move their order in memory drifts away from their order in space,
+// and anything walking the grid ends up jumping all over the body array.
+// Running this every so often puts neighbours back next to each other.
+//
+// After a reorder, anything holding a body index must be remapped with
+// getNewIndex (or ContactPairSet::remap), and the grid must be rebuilt.
+// Pointers to bodies are not fixed up.
+//
+// Indices are 16-bit by default, which limits Capacity to 65536 bodies.
+// A wider IndexType allows more, though three indices are kept per body.
+// ContactPairSet keys are 16-bit body IDs, so its remap only takes the default.
+//
+template< size_t CapacityValue, typename IndexTypeValue = uint16_t >
+class MortonOrder
+{
+public:
+	static constexpr size_t Capacity = CapacityValue;
+	using IndexType = IndexTypeValue;
+
+	static_assert(static_cast<IndexType>(Capacity - 1) == (Capacity - 1), "Capacity must fit IndexType");
+
+private:
+	// Fields
+	uint16_t keys[Capacity];
+	IndexType order[Capacity];
+	uint16_t scratchKeys[Capacity];
+	IndexType scratchOrder[Capacity];
+	IndexType newIndices[Capacity];
+	size_t count = 0;
+
+public:
+	// Where the body that used to be at index is now
+	// Only valid after reorder
+	IndexType getNewIndex(IndexType index) const
+	{
+		return this->newIndices[index];
+	}
+
+	const IndexType * getNewIndices(void) const
+	{
+		return this->newIndices;
+	}
+
+	constexpr size_t getCount(void) const
+	{
+		return this->count;
+	}
+
+	template< typename Grid, size_t size >
+	void reorder(const Grid & grid, RigidBody (&bodies)[size])
+	{
+		static_assert(size <= Capacity, "Too many bodies");
+
+		this->count = size;
+
+		for(size_t i = 0; i < size; ++i)
+		{
+			const Point2 position = bodies[i].position;
+			this->keys[i] = getMortonCode(grid.getColumn(position.x), grid.getRow(position.y));
+			this->order[i] = static_cast<IndexType>(i);
+		}
+
+		radixSort(this->keys, this->order, this->scratchKeys, this->scratchOrder, size);
+
+		for(size_t i = 0; i < size; ++i)
+			this->newIndices[this->order[i]] = static_cast<IndexType>(i);
+
+		// Permute in place by following cycles, on a copy of the mapping
+		IndexType * const targets = this->scratchOrder;
+		for(size_t i = 0; i < size; ++i)
+			targets[i] = this->newIndices[i];
+
+		for(size_t i = 0; i < size; ++i)
+			while(targets[i] != i)
+			{
+				const IndexType target = targets[i];
+				swap(bodies[i], bodies[target]);
+				swap(targets[i], targets[target]);
+			}
+	}
+};
+
+template< size_t CapacityValue, typename IndexTypeValue >
+constexpr size_t MortonOrder<CapacityValue, IndexTypeValue>::Capacity;
@@ -0,0 +1,65 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+
+// Define PHYSICS_USE_THREADS on hosts with std::thread to spread
+// the heavier batch passes over several threads
+// Without it everything runs on the calling thread
+#if defined(PHYSICS_USE_THREADS)
+#include <thread>
+#endif
+
+constexpr size_t MaxThreadCount = 16;
+
+inline size_t getThreadCount(void)
+{
+#if defined(PHYSICS_USE_THREADS)
+	const size_t count = std::thread::hardware_concurrency();
+	return clamp<size_t>(count, 1, MaxThreadCount);
+#else
+	return 1;
+#endif
+}
+
+// Where the given thread's share of count items starts
+constexpr size_t getChunkBegin(size_t count, size_t thread, size_t threadCount)
+{
+	return ((count * thread) / threadCount);
+}
+
+// Calls function(thread) once for each thread from 0 to threadCount,
+// in parallel if threads are enabled, and waits for them all
+template< typename Function >
+void runOnThreads(size_t threadCount, Function function)
+{
+#if defined(PHYSICS_USE_THREADS)
+	std::thread threads[MaxThreadCount];
+
+	for(size_t thread = 1; thread < threadCount; ++thread)
+		threads[thread] = std::thread(function, thread);
+
+	function(static_cast<size_t>(0));
+
+	for(size_t thread = 1; thread < threadCount; ++thread)
+		threads[thread].join();
+#else
+	for(size_t thread = 0; thread < threadCount; ++thread)
+		function(thread);
+#endif
+}
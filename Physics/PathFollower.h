@@ -0,0 +1,298 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "RigidBody.h"
+
+//
+// A path through a set of control points, stored as points spaced
+// evenly along its length, so that following it at a steady speed
+// is just a table lookup and a lerp.
+//
+// The path is a Catmull-Rom spline, which passes through every control point.
+// Building the table is slow and meant to be done when the level loads.
+//
+template< size_t SampleCountValue >
+class PathTable
+{
+public:
+	static constexpr size_t SampleCount = SampleCountValue;
+
+	// How finely each spline segment is walked when measuring its length
+	static constexpr uint8_t StepsPerSegment = 16;
+
+	static_assert(SampleCount >= 2, "PathTable needs at least two samples");
+
+private:
+	// Fields
+	Point2 samples[SampleCount];
+	Number spacing = 0;
+	Number length = 0;
+	bool looped = false;
+
+public:
+	constexpr Number getLength(void) const
+	{
+		return this->length;
+	}
+
+	constexpr bool isLooped(void) const
+	{
+		return this->looped;
+	}
+
+	// A looped path joins its last control point back to its first
+	template< size_t controlCount >
+	void build(const Point2 (&controlPoints)[controlCount], bool looped)
+	{
+		static_assert(controlCount >= 2, "A path needs at least two control points");
+
+		this->looped = looped;
+
+		// First pass measures, second pass places the samples
+		this->length = 0;
+		this->walk(controlPoints, [this](Point2, Point2, Number segmentLength)
+		{
+			this->length += segmentLength;
+		});
+
+		// A looped path's last sample wraps back around to the first
+		this->spacing = (this->length / static_cast<int32_t>(looped ? SampleCount : (SampleCount - 1)));
+
+		size_t next = 0;
+		Number travelled = 0;
+
+		this->walk(controlPoints, [this, &next, &travelled](Point2 start, Point2 end, Number segmentLength)
+		{
+			while((next < SampleCount) && (segmentLength > 0))
+			{
+				const Number target = (this->spacing * static_cast<int32_t>(next));
+				if(target > (travelled + segmentLength))
+					break;
+
+				const Number along = ((target - travelled) / segmentLength);
+				this->samples[next] = (start + ((end - start) * along));
+				++next;
+			}
+
+			travelled += segmentLength;
+		});
+
+		// Rounding can leave the last few samples unset
+		for(; next < SampleCount; ++next)
+			this->samples[next] = looped ? controlPoints[0] : controlPoints[controlCount - 1];
+	}
+
+	// The same place on a looped path, brought into [0, length)
+	Number wrapDistance(Number distance) const
+	{
+		if(this->length <= 0)
+			return 0;
+
+		int32_t internal = (distance.getInternal() % this->length.getInternal());
+		if(internal < 0)
+			internal += this->length.getInternal();
+
+		return Number::fromInternal(internal);
+	}
+
+	// The point the given distance along the path
+	// Distances wrap on looped paths and clamp otherwise
+	Point2 getPoint(Number distance) const
+	{
+		if(this->spacing <= 0)
+			return this->samples[0];
+
+		if(this->looped)
+		{
+			distance = this->wrapDistance(distance);
+		}
+		else
+		{
+			if(distance <= 0)
+				return this->samples[0];
+
+			if(distance >= this->length)
+				return this->samples[SampleCount - 1];
+		}
+
+		const Number position = (distance / this->spacing);
+		const size_t index = static_cast<size_t>(position.getInteger());
+		const Number fraction = Number::fromInternal(position.getFraction());
+
+		if(index >= (SampleCount - 1))
+		{
+			if(!this->looped)
+				return this->samples[SampleCount - 1];
+
+			// Between the last sample and the first
+			const Point2 start = this->samples[SampleCount - 1];
+			return (start + ((this->samples[0] - start) * fraction));
+		}
+
+		const Point2 start = this->samples[index];
+		const Point2 end = this->samples[index + 1];
+		return (start + ((end - start) * fraction));
+	}
+
+private:
+	static Point2 getControlPoint(const Point2 * controlPoints, size_t controlCount, int32_t index, bool looped)
+	{
+		if(looped)
+			return controlPoints[(index + static_cast<int32_t>(controlCount)) % static_cast<int32_t>(controlCount)];
+
+		return controlPoints[(index < 0) ? 0 : (index >= static_cast<int32_t>(controlCount)) ? (controlCount - 1) : index];
+	}
+
+	// Catmull-Rom between second and third, t in [0, 1]
+	static Point2 interpolate(Point2 first, Point2 second, Point2 third, Point2 fourth, Number t)
+	{
+		return Point2(interpolate(first.x, second.x, third.x, fourth.x, t), interpolate(first.y, second.y, third.y, fourth.y, t));
+	}
+
+	// The coefficients can be several times bigger than any coordinate,
+	// so this is worked in 64 bits with Number's fraction bits
+	static Number interpolate(Number first, Number second, Number third, Number fourth, Number t)
+	{
+		const int64_t p0 = first.getInternal();
+		const int64_t p1 = second.getInternal();
+		const int64_t p2 = third.getInternal();
+		const int64_t p3 = fourth.getInternal();
+		const int64_t fraction = t.getInternal();
+
+		const int64_t a = (p1 * 2);
+		const int64_t b = (p2 - p0);
+		const int64_t c = ((p0 * 2) - (p1 * 5) + (p2 * 4) - p3);
+		const int64_t d = ((p1 * 3) - p0 - (p2 * 3) + p3);
+
+		// a + bt + ct^2 + dt^3, one multiply at a time
+		int64_t result = (((d * fraction) >> Number::FractionSize) + c);
+		result = (((result * fraction) >> Number::FractionSize) + b);
+		result = (((result * fraction) >> Number::FractionSize) + a);
+
+		// The curve can overshoot its control points a little
+		return saturateNumber(result / 2);
+	}
+
+	// Calls function(start, end, length) for each short straight piece of the spline
+	template< size_t controlCount, typename Function >
+	void walk(const Point2 (&controlPoints)[controlCount], Function function) const
+	{
+		const size_t segmentCount = this->looped ? controlCount : (controlCount - 1);
+		const Number step = (Number(1) / StepsPerSegment);
+
+		Point2 previous = controlPoints[0];
+
+		for(size_t segment = 0; segment < segmentCount; ++segment)
+		{
+			const int32_t index = static_cast<int32_t>(segment);
+			const Point2 first = getControlPoint(controlPoints, controlCount, index - 1, this->looped);
+			const Point2 second = getControlPoint(controlPoints, controlCount, index, this->looped);
+			const Point2 third = getControlPoint(controlPoints, controlCount, index + 1, this->looped);
+			const Point2 fourth = getControlPoint(controlPoints, controlCount, index + 2, this->looped);
+
+			for(uint8_t i = 1; i <= StepsPerSegment; ++i)
+			{
+				// Land exactly on the control point rather than near it
+				const Point2 current = (i == StepsPerSegment) ? third : interpolate(first, second, third, fourth, (step * i));
+				function(previous, current, (current - previous).getMagnitude());
+				previous = current;
+			}
+		}
+	}
+};
+
+template< size_t SampleCountValue >
+constexpr size_t PathTable<SampleCountValue>::SampleCount;
+
+template< size_t SampleCountValue >
+constexpr uint8_t PathTable<SampleCountValue>::StepsPerSegment;
+
+//
+// Moves a body along a PathTable at a steady speed
+//
+// The body is kinematic: it should be left out of the normal integration.
+// Its velocity is set to how far it moved this step, so anything
+// riding on it or bumping into it sees the right motion.
+//
+template< size_t SampleCount >
+class PathFollower
+{
+public:
+	// Fields
+	const PathTable<SampleCount> * path = nullptr;
+	RigidBody * body = nullptr;
+
+	Number distance = 0;
+
+	// Distance per tick
+	Number speed = 1;
+
+	// On an open path, turn around at the ends instead of stopping
+	bool pingPong = true;
+
+public:
+	// Constructors
+	PathFollower(void) = default;
+	PathFollower(const PathTable<SampleCount> & path, RigidBody & body, Number speed) : path(&path), body(&body), speed(speed) {}
+
+	void update(void)
+	{
+		if((this->path == nullptr) || (this->body == nullptr))
+			return;
+
+		this->distance += this->speed;
+
+		// Kept within one lap, so it can't creep up to Number's limit and overflow
+		if(this->path->isLooped())
+		{
+			this->distance = this->path->wrapDistance(this->distance);
+		}
+		else
+		{
+			const Number length = this->path->getLength();
+
+			if(this->distance >= length)
+			{
+				this->distance = length;
+				if(this->pingPong)
+					this->speed = -this->speed;
+			}
+			else if(this->distance <= 0)
+			{
+				this->distance = 0;
+				if(this->pingPong)
+					this->speed = -this->speed;
+			}
+		}
+
+		const Point2 position = this->path->getPoint(this->distance);
+		this->body->velocity = (position - this->body->position);
+		this->body->position = position;
+	}
+};
+
+// Updates every follower in the array
+template< size_t SampleCount, size_t size >
+void updatePathFollowers(PathFollower<SampleCount> (&followers)[size])
+{
+	for(size_t i = 0; i < size; ++i)
+		followers[i].update();
+}
@@ -20,3 +20,37 @@
 #include "RigidBody.h"
 #include "Circle.h"
 #include "Rectangle.h"
+#include "BoundedHeap.h"
+#include "UniformGrid.h"
+#include "SpatialQueries.h"
+#include "BarnesHutGravity.h"
+#include "Forces.h"
+#include "ForceField.h"
+#include "Flocking.h"
+#include "Integrator.h"
+#include "TrajectoryPredictor.h"
+#include "EventSimulation.h"
+#include "PathFollower.h"
+#include "TerrainMask.h"
+#include "FastRandom.h"
+#include "SandSimulation.h"
+#include "Heightfield.h"
+#include "Segment.h"
+#include "Capsule.h"
+#include "Intersections.h"
+#include "Shape.h"
+#include "CompoundShape.h"
+#include "CharacterController.h"
+#include "ContactPairSet.h"
+#include "RadixSort.h"
+#include "MortonOrder.h"
+#include "Parallel.h"
+#include "SortedBroadPhase.h"
+#include "HierarchicalGrid.h"
+#include "GridTuner.h"
+#include "FrameGovernor.h"
+#include "LevelOfDetail.h"
+#include "StepKernel.h"
+#include "VectorExpression.h"
+#include "Matrix.h"
+#include "Transform.h"
@@ -65,6 +65,29 @@ inline constexpr NumberU distanceSquared(Point2 firstPoint, Point2 secondPoint)
 	return fromSigned(square(firstPoint.x - secondPoint.x) + square(firstPoint.y - secondPoint.y));
 }
 
+// Square of the difference between two coordinates, as a WideNumber's internal value
+// The difference is taken before narrowing, so it can't overflow
+inline constexpr uint64_t getSquaredDifferenceInternal(Number first, Number second)
+{
+	return
+		static_cast<uint64_t>((first > second) ? (static_cast<int64_t>(first.getInternal()) - second.getInternal()) : (static_cast<int64_t>(second.getInternal()) - first.getInternal())) *
+		static_cast<uint64_t>((first > second) ? (static_cast<int64_t>(first.getInternal()) - second.getInternal()) : (static_cast<int64_t>(second.getInternal()) - first.getInternal()));
+}
+
+inline constexpr WideNumber saturateWideSum(uint64_t first, uint64_t second)
+{
+	return ((first > static_cast<uint64_t>(MaxWideNumber.getInternal())) || (second > (static_cast<uint64_t>(MaxWideNumber.getInternal()) - first))) ?
+		MaxWideNumber :
+		WideNumber::fromInternal(static_cast<int64_t>(first + second));
+}
+
+// Square distance between two points, widened so that it can't overflow
+// Points more than about 46000 apart saturate to MaxWideNumber
+inline constexpr WideNumber distanceSquaredWide(Point2 firstPoint, Point2 secondPoint)
+{
+	return saturateWideSum(getSquaredDifferenceInternal(firstPoint.x, secondPoint.x), getSquaredDifferenceInternal(firstPoint.y, secondPoint.y));
+}
+
 //
 // Vector & Point interaction
 //
@@ -0,0 +1,151 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Parallel.h"
+
+// Sorts keys into ascending order, moving values along with them
+// Goes a byte at a time from the least significant end,
+// skipping any byte that's the same for every key
+// The scratch arrays must be as long as the inputs
+// Stable, so equal keys keep their relative order
+template< typename Key, typename Value >
+void radixSort(Key * keys, Value * values, Key * scratchKeys, Value * scratchValues, size_t count)
+{
+	if(count == 0)
+		return;
+
+	Key * sourceKeys = keys;
+	Value * sourceValues = values;
+	Key * targetKeys = scratchKeys;
+	Value * targetValues = scratchValues;
+
+	for(uint8_t shift = 0; shift < (sizeof(Key) * 8); shift += 8)
+	{
+		size_t offsets[256] = {};
+
+		for(size_t i = 0; i < count; ++i)
+			++offsets[(sourceKeys[i] >> shift) & 0xFF];
+
+		// Every key has the same byte here, so this pass wouldn't move anything
+		if(offsets[(sourceKeys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		size_t total = 0;
+		for(size_t bucket = 0; bucket < 256; ++bucket)
+		{
+			const size_t size = offsets[bucket];
+			offsets[bucket] = total;
+			total += size;
+		}
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			const size_t target = offsets[(sourceKeys[i] >> shift) & 0xFF]++;
+			targetKeys[target] = sourceKeys[i];
+			targetValues[target] = sourceValues[i];
+		}
+
+		swap(sourceKeys, targetKeys);
+		swap(sourceValues, targetValues);
+	}
+
+	if(sourceKeys != keys)
+		for(size_t i = 0; i < count; ++i)
+		{
+			keys[i] = sourceKeys[i];
+			values[i] = sourceValues[i];
+		}
+}
+
+// As radixSort, but each pass is split over the available threads
+// Every thread builds a histogram of its own share of the keys,
+// and the prefix sum runs over (bucket, thread) so the sort stays stable
+template< typename Key, typename Value >
+void radixSortParallel(Key * keys, Value * values, Key * scratchKeys, Value * scratchValues, size_t count)
+{
+	// Below this, starting threads costs more than it saves
+	constexpr size_t MinimumPerThread = 16384;
+
+	const size_t threadCount = clamp<size_t>(count / MinimumPerThread, 1, getThreadCount());
+
+	if(threadCount == 1)
+	{
+		radixSort(keys, values, scratchKeys, scratchValues, count);
+		return;
+	}
+
+	Key * sourceKeys = keys;
+	Value * sourceValues = values;
+	Key * targetKeys = scratchKeys;
+	Value * targetValues = scratchValues;
+
+	for(uint8_t shift = 0; shift < (sizeof(Key) * 8); shift += 8)
+	{
+		size_t offsets[MaxThreadCount][256] = {};
+
+		runOnThreads(threadCount, [&](size_t thread)
+		{
+			const size_t end = getChunkBegin(count, thread + 1, threadCount);
+			for(size_t i = getChunkBegin(count, thread, threadCount); i < end; ++i)
+				++offsets[thread][(sourceKeys[i] >> shift) & 0xFF];
+		});
+
+		size_t total = 0;
+		bool isSkippable = false;
+		for(size_t bucket = 0; bucket < 256; ++bucket)
+		{
+			const size_t bucketBegin = total;
+
+			for(size_t thread = 0; thread < threadCount; ++thread)
+			{
+				const size_t size = offsets[thread][bucket];
+				offsets[thread][bucket] = total;
+				total += size;
+			}
+
+			// Every key has the same byte here, so this pass wouldn't move anything
+			if((total - bucketBegin) == count)
+				isSkippable = true;
+		}
+
+		if(isSkippable)
+			continue;
+
+		runOnThreads(threadCount, [&](size_t thread)
+		{
+			const size_t end = getChunkBegin(count, thread + 1, threadCount);
+			for(size_t i = getChunkBegin(count, thread, threadCount); i < end; ++i)
+			{
+				const size_t target = offsets[thread][(sourceKeys[i] >> shift) & 0xFF]++;
+				targetKeys[target] = sourceKeys[i];
+				targetValues[target] = sourceValues[i];
+			}
+		});
+
+		swap(sourceKeys, targetKeys);
+		swap(sourceValues, targetValues);
+	}
+
+	if(sourceKeys != keys)
+		for(size_t i = 0; i < count; ++i)
+		{
+			keys[i] = sourceKeys[i];
+			values[i] = sourceValues[i];
+		}
+}
@@ -103,4 +103,15 @@ constexpr inline bool intersects(Rectangle first, Rectangle second)
 		(first.getBottom() < second.getTop()) ||
 		(first.getTop() > second.getBottom())
 	);
+}
+
+// The smallest rectangle containing both rectangles
+inline Rectangle getUnion(Rectangle first, Rectangle second)
+{
+	const Number left = (first.getLeft() < second.getLeft()) ? first.getLeft() : second.getLeft();
+	const Number top = (first.getTop() < second.getTop()) ? first.getTop() : second.getTop();
+	const Number right = (first.getRight() > second.getRight()) ? first.getRight() : second.getRight();
+	const Number bottom = (first.getBottom() > second.getBottom()) ? first.getBottom() : second.getBottom();
+
+	return Rectangle(left, top, Size2(fromSigned(right - left), fromSigned(bottom - top)));
 }
\ No newline at end of file
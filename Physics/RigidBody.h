@@ -49,3 +49,54 @@ public:
 		this->velocity += (force / mass);
 	}
 };
+
+// Body pools are most of the RAM a game uses, so this mustn't grow by accident
+static_assert(sizeof(RigidBody) == 20, "RigidBody should be 20 bytes");
+
+//
+// Whether a body is asleep, and how many frames in a row it's been slow enough to sleep
+//
+// Kept in an array beside the bodies rather than in RigidBody,
+// which has no padding to spare, so it costs one byte per body instead of four.
+// Sleeping bodies are at rest and can be skipped until something wakes them.
+//
+class SleepState
+{
+public:
+	// An enumerator rather than a static member, so it needs no definition
+	enum : uint8_t { MaxQuietFrames = 0x7F };
+
+private:
+	// Top bit is the sleeping flag, the rest count quiet frames
+	uint8_t value = 0;
+
+public:
+	constexpr bool isSleeping(void) const
+	{
+		return ((this->value & 0x80) != 0);
+	}
+
+	constexpr uint8_t getQuietFrames(void) const
+	{
+		return (this->value & MaxQuietFrames);
+	}
+
+	void sleep(void)
+	{
+		this->value |= 0x80;
+	}
+
+	// Counts up to MaxQuietFrames and stays there
+	void addQuietFrame(void)
+	{
+		if(this->getQuietFrames() < MaxQuietFrames)
+			++this->value;
+	}
+
+	// Call when something touches or pushes the body,
+	// so it has to stay quiet for a while again before it can sleep
+	void wake(void)
+	{
+		this->value = 0;
+	}
+};
@@ -0,0 +1,319 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "FastRandom.h"
+
+enum class SandMaterial : uint8_t
+{
+	Empty,
+	Sand,
+	Water,
+	// Never moves, for walls and floors
+	Stone,
+};
+
+//
+// A falling-sand cellular automaton
+//
+// Each cell is one byte: the low bits hold the material and the top bit
+// records which frame the cell last moved in, so nothing moves twice per step.
+//
+// The grid is split into square chunks with one bit each saying whether
+// anything in or next to the chunk changed last step.
+// Chunks that have settled are skipped entirely.
+//
+// Rows are updated from the bottom up so falling cells move once per step,
+// and the horizontal direction alternates every step so that
+// sideways flow isn't biased to one side.
+//
+template< uint16_t WidthValue, uint16_t HeightValue >
+class SandSimulation
+{
+public:
+	static constexpr uint16_t Width = WidthValue;
+	static constexpr uint16_t Height = HeightValue;
+
+	static constexpr uint8_t ChunkShift = 3;
+	static constexpr uint8_t ChunkSize = (1 << ChunkShift);
+	static constexpr uint16_t ChunkColumns = ((Width + ChunkSize - 1) / ChunkSize);
+	static constexpr uint16_t ChunkRows = ((Height + ChunkSize - 1) / ChunkSize);
+
+	static_assert(ChunkColumns <= 32, "SandSimulation is too wide for its chunk bitmap");
+
+private:
+	static constexpr uint8_t MaterialMask = 0x7F;
+	static constexpr uint8_t ClockMask = 0x80;
+
+private:
+	// Fields
+	uint8_t cells[Height][Width];
+
+	// One bit per chunk, one word per row of chunks
+	uint32_t activeChunks[ChunkRows];
+	uint32_t nextActiveChunks[ChunkRows];
+
+	uint8_t clock = 0;
+	FastRandom random;
+
+public:
+	// Constructors
+	SandSimulation(void)
+	{
+		this->clear();
+	}
+
+	void clear(void)
+	{
+		for(uint16_t y = 0; y < Height; ++y)
+			for(uint16_t x = 0; x < Width; ++x)
+				this->cells[y][x] = static_cast<uint8_t>(SandMaterial::Empty);
+
+		for(uint16_t row = 0; row < ChunkRows; ++row)
+		{
+			this->activeChunks[row] = 0;
+			this->nextActiveChunks[row] = 0;
+		}
+	}
+
+	SandMaterial getCell(int16_t x, int16_t y) const
+	{
+		if((x < 0) || (x >= Width) || (y < 0) || (y >= Height))
+			return SandMaterial::Stone;
+
+		return static_cast<SandMaterial>(this->cells[y][x] & MaterialMask);
+	}
+
+	void setCell(int16_t x, int16_t y, SandMaterial material)
+	{
+		if((x < 0) || (x >= Width) || (y < 0) || (y >= Height))
+			return;
+
+		this->cells[y][x] = static_cast<uint8_t>(material);
+		this->wake(x, y);
+	}
+
+	// The number of chunks that will be updated next step
+	uint16_t getActiveChunkCount(void) const
+	{
+		uint16_t count = 0;
+		for(uint16_t row = 0; row < ChunkRows; ++row)
+			for(uint32_t bits = this->nextActiveChunks[row]; bits != 0; bits &= (bits - 1))
+				++count;
+		return count;
+	}
+
+	void step(void)
+	{
+		for(uint16_t row = 0; row < ChunkRows; ++row)
+		{
+			this->activeChunks[row] = this->nextActiveChunks[row];
+			this->nextActiveChunks[row] = 0;
+		}
+
+		this->clock ^= ClockMask;
+		const bool leftToRight = (this->clock != 0);
+
+		for(int16_t y = (Height - 1); y >= 0; --y)
+		{
+			const uint32_t chunks = this->activeChunks[y >> ChunkShift];
+			if(chunks == 0)
+				continue;
+
+			for(uint16_t i = 0; i < ChunkColumns; ++i)
+			{
+				const uint16_t chunk = leftToRight ? i : (ChunkColumns - 1 - i);
+				if((chunks & (UINT32_C(1) << chunk)) == 0)
+					continue;
+
+				const int16_t start = (chunk << ChunkShift);
+				const int16_t end = ((start + ChunkSize) < Width) ? (start + ChunkSize) : Width;
+
+				if(leftToRight)
+				{
+					for(int16_t x = start; x < end; ++x)
+						this->updateCell(x, y);
+				}
+				else
+				{
+					for(int16_t x = (end - 1); x >= start; --x)
+						this->updateCell(x, y);
+				}
+			}
+		}
+	}
+
+	// Draws straight into a 4-bit-per-pixel framebuffer, two pixels per byte,
+	// left pixel in the high nibble, as used by the Pokitto's high resolution mode
+	// Each cell covers scale by scale pixels
+	// palette maps each material to a colour index
+	void render(uint8_t * buffer, uint16_t bufferWidth, uint8_t scale, const uint8_t (&palette)[4]) const
+	{
+		const uint16_t bytesPerRow = (bufferWidth / 2);
+
+		for(uint16_t y = 0; y < Height; ++y)
+		{
+			uint8_t * line = &buffer[(y * scale) * bytesPerRow];
+
+			for(uint16_t x = 0; x < Width; ++x)
+			{
+				const uint8_t colour = (palette[this->cells[y][x] & MaterialMask] & 0x0F);
+
+				for(uint8_t i = 0; i < scale; ++i)
+				{
+					const uint16_t pixel = ((x * scale) + i);
+					uint8_t & pair = line[pixel / 2];
+					pair = ((pixel & 1) == 0) ? ((pair & 0x0F) | (colour << 4)) : ((pair & 0xF0) | colour);
+				}
+			}
+
+			// Copy the finished line down for the rest of the cell's height
+			for(uint8_t i = 1; i < scale; ++i)
+				for(uint16_t byte = 0; byte < ((Width * scale) / 2); ++byte)
+					line[(i * bytesPerRow) + byte] = line[byte];
+		}
+	}
+
+private:
+	// Marks the chunk holding the cell as active next step,
+	// along with any neighbouring chunk the cell borders
+	void wake(int16_t x, int16_t y)
+	{
+		const uint16_t chunkX = (x >> ChunkShift);
+		const uint16_t chunkY = (y >> ChunkShift);
+
+		uint32_t bits = (UINT32_C(1) << chunkX);
+
+		if(((x & (ChunkSize - 1)) == 0) && (chunkX > 0))
+			bits |= (UINT32_C(1) << (chunkX - 1));
+
+		if(((x & (ChunkSize - 1)) == (ChunkSize - 1)) && ((chunkX + 1) < ChunkColumns))
+			bits |= (UINT32_C(1) << (chunkX + 1));
+
+		this->nextActiveChunks[chunkY] |= bits;
+
+		if(((y & (ChunkSize - 1)) == 0) && (chunkY > 0))
+			this->nextActiveChunks[chunkY - 1] |= bits;
+
+		if(((y & (ChunkSize - 1)) == (ChunkSize - 1)) && ((chunkY + 1) < ChunkRows))
+			this->nextActiveChunks[chunkY + 1] |= bits;
+	}
+
+	// Returns true if a cell of the given material can move into (x, y)
+	bool canEnter(int16_t x, int16_t y, SandMaterial material) const
+	{
+		const SandMaterial target = this->getCell(x, y);
+
+		// Sand sinks through water
+		return (target == SandMaterial::Empty) || ((material == SandMaterial::Sand) && (target == SandMaterial::Water));
+	}
+
+	void move(int16_t fromX, int16_t fromY, int16_t toX, int16_t toY)
+	{
+		const uint8_t moved = ((this->cells[fromY][fromX] & MaterialMask) | this->clock);
+
+		this->cells[fromY][fromX] = this->cells[toY][toX];
+		this->cells[toY][toX] = moved;
+
+		this->wake(fromX, fromY);
+		this->wake(toX, toY);
+	}
+
+	// Tries (x + first, y + dy) then (x - first, y + dy) in a random order
+	bool tryDiagonal(int16_t x, int16_t y, int16_t dy, SandMaterial material)
+	{
+		const int16_t first = this->random.nextBool() ? 1 : -1;
+
+		if(this->canEnter(x + first, y + dy, material))
+		{
+			this->move(x, y, x + first, y + dy);
+			return true;
+		}
+
+		if(this->canEnter(x - first, y + dy, material))
+		{
+			this->move(x, y, x - first, y + dy);
+			return true;
+		}
+
+		return false;
+	}
+
+	void updateCell(int16_t x, int16_t y)
+	{
+		const uint8_t cell = this->cells[y][x];
+		const SandMaterial material = static_cast<SandMaterial>(cell & MaterialMask);
+
+		if((material == SandMaterial::Empty) || (material == SandMaterial::Stone))
+			return;
+
+		// Either it already moved this step, or it's been asleep since a step
+		// with the same clock, so try again next step
+		if((cell & ClockMask) == this->clock)
+		{
+			this->wake(x, y);
+			return;
+		}
+
+		this->cells[y][x] = (static_cast<uint8_t>(material) | this->clock);
+
+		switch(material)
+		{
+			case SandMaterial::Sand:
+				if(this->canEnter(x, y + 1, material))
+					this->move(x, y, x, y + 1);
+				else
+					this->tryDiagonal(x, y, 1, material);
+				break;
+
+			case SandMaterial::Water:
+				if(this->canEnter(x, y + 1, material))
+					this->move(x, y, x, y + 1);
+				else if(!this->tryDiagonal(x, y, 1, material))
+					this->tryDiagonal(x, y, 0, material);
+				break;
+
+			default:
+				break;
+		}
+	}
+};
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint16_t SandSimulation<WidthValue, HeightValue>::Width;
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint16_t SandSimulation<WidthValue, HeightValue>::Height;
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint8_t SandSimulation<WidthValue, HeightValue>::ChunkShift;
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint8_t SandSimulation<WidthValue, HeightValue>::ChunkSize;
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint16_t SandSimulation<WidthValue, HeightValue>::ChunkColumns;
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint16_t SandSimulation<WidthValue, HeightValue>::ChunkRows;
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint8_t SandSimulation<WidthValue, HeightValue>::MaterialMask;
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint8_t SandSimulation<WidthValue, HeightValue>::ClockMask;
@@ -0,0 +1,85 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+
+class Segment
+{
+public:
+	// Fields
+	Point2 start;
+	Point2 end;
+
+public:
+	// Constructors
+	constexpr Segment(void) = default;
+	constexpr Segment(Point2 start, Point2 end) : start(start), end(end) {}
+	constexpr Segment(Number startX, Number startY, Number endX, Number endY) : start(startX, startY), end(endX, endY) {}
+
+	constexpr Vector2 getDirection(void) const
+	{
+		return (this->end - this->start);
+	}
+
+	constexpr WideNumber getLengthSquared(void) const
+	{
+		return this->getDirection().getMagnitudeSquaredWide();
+	}
+
+	// How far along the segment the closest point to point lies,
+	// 0 at the start and 1 at the end
+	Number getClosestParameter(Point2 point) const
+	{
+		const Vector2 direction = this->getDirection();
+		const Vector2 offset = (point - this->start);
+
+		const WideNumber lengthSquared = direction.getMagnitudeSquaredWide();
+		const WideNumber projection = dotWide(offset, direction);
+
+		if((lengthSquared <= 0) || (projection <= 0))
+			return 0;
+
+		if(projection >= lengthSquared)
+			return 1;
+
+		return divide(projection, lengthSquared);
+	}
+
+	Point2 getClosestPoint(Point2 point) const
+	{
+		return (this->start + (this->getDirection() * this->getClosestParameter(point)));
+	}
+
+	// Square distance from the segment to a point
+	WideNumber getDistanceSquared(Point2 point) const
+	{
+		return distanceSquaredWide(this->getClosestPoint(point), point);
+	}
+};
+
+inline constexpr bool operator ==(Segment left, Segment right)
+{
+	return ((left.start == right.start) && (left.end == right.end));
+}
+
+inline constexpr bool operator !=(Segment left, Segment right)
+{
+	return ((left.start != right.start) || (left.end != right.end));
+}
@@ -0,0 +1,170 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Circle.h"
+#include "Rectangle.h"
+#include "Segment.h"
+#include "Capsule.h"
+#include "Intersections.h"
+
+enum class ShapeType : uint8_t
+{
+	Circle,
+	Rectangle,
+	Segment,
+	Capsule,
+};
+
+constexpr uint8_t ShapeTypeCount = 4;
+
+// Any one of the shapes, for when the kind isn't known until runtime
+class Shape
+{
+public:
+	// Fields
+	ShapeType type;
+
+	union
+	{
+		Circle circle;
+		Rectangle rectangle;
+		Segment segment;
+		Capsule capsule;
+	};
+
+public:
+	// Constructors
+	Shape(void) : type(ShapeType::Circle), circle() {}
+	Shape(Circle circle) : type(ShapeType::Circle), circle(circle) {}
+	Shape(Rectangle rectangle) : type(ShapeType::Rectangle), rectangle(rectangle) {}
+	Shape(Segment segment) : type(ShapeType::Segment), segment(segment) {}
+	Shape(Capsule capsule) : type(ShapeType::Capsule), capsule(capsule) {}
+
+	// The smallest rectangle containing the shape
+	Rectangle getBounds(void) const
+	{
+		switch(this->type)
+		{
+			case ShapeType::Circle:
+				return getBounds(this->circle.position, this->circle.position, fromUnsigned(this->circle.radius));
+
+			case ShapeType::Rectangle:
+				return this->rectangle;
+
+			case ShapeType::Segment:
+				return getBounds(this->segment.start, this->segment.end, 0);
+
+			case ShapeType::Capsule:
+				return getBounds(this->capsule.segment.start, this->capsule.segment.end, fromUnsigned(this->capsule.radius));
+		}
+
+		return Rectangle();
+	}
+
+	// A copy of the shape moved by offset
+	Shape getTranslated(Vector2 offset) const
+	{
+		Shape result = *this;
+
+		switch(this->type)
+		{
+			case ShapeType::Circle:
+				result.circle.position += offset;
+				break;
+
+			case ShapeType::Rectangle:
+				result.rectangle.position += offset;
+				break;
+
+			case ShapeType::Segment:
+				result.segment.start += offset;
+				result.segment.end += offset;
+				break;
+
+			case ShapeType::Capsule:
+				result.capsule.segment.start += offset;
+				result.capsule.segment.end += offset;
+				break;
+		}
+
+		return result;
+	}
+
+private:
+	// Bounds of the two points, grown by radius on every side
+	static Rectangle getBounds(Point2 first, Point2 second, Number radius)
+	{
+		const Number left = (((first.x < second.x) ? first.x : second.x) - radius);
+		const Number top = (((first.y < second.y) ? first.y : second.y) - radius);
+		const Number right = (((first.x > second.x) ? first.x : second.x) + radius);
+		const Number bottom = (((first.y > second.y) ? first.y : second.y) + radius);
+
+		return Rectangle(left, top, Size2(fromSigned(right - left), fromSigned(bottom - top)));
+	}
+};
+
+template< typename T >
+struct ShapeAccess;
+
+template<>
+struct ShapeAccess<Circle>
+{
+	static const Circle & get(const Shape & shape) { return shape.circle; }
+};
+
+template<>
+struct ShapeAccess<Rectangle>
+{
+	static const Rectangle & get(const Shape & shape) { return shape.rectangle; }
+};
+
+template<>
+struct ShapeAccess<Segment>
+{
+	static const Segment & get(const Shape & shape) { return shape.segment; }
+};
+
+template<>
+struct ShapeAccess<Capsule>
+{
+	static const Capsule & get(const Shape & shape) { return shape.capsule; }
+};
+
+using ShapeTest = bool (*)(const Shape & first, const Shape & second);
+
+template< typename First, typename Second >
+bool intersectsAs(const Shape & first, const Shape & second)
+{
+	return intersects(ShapeAccess<First>::get(first), ShapeAccess<Second>::get(second));
+}
+
+// Picks the right test for the two shapes from a table indexed by their types
+inline bool intersects(const Shape & first, const Shape & second)
+{
+	// Rows and columns are in ShapeType order
+	static const ShapeTest tests[ShapeTypeCount][ShapeTypeCount] =
+	{
+		{ &intersectsAs<Circle, Circle>, &intersectsAs<Circle, Rectangle>, &intersectsAs<Circle, Segment>, &intersectsAs<Circle, Capsule> },
+		{ &intersectsAs<Rectangle, Circle>, &intersectsAs<Rectangle, Rectangle>, &intersectsAs<Rectangle, Segment>, &intersectsAs<Rectangle, Capsule> },
+		{ &intersectsAs<Segment, Circle>, &intersectsAs<Segment, Rectangle>, &intersectsAs<Segment, Segment>, &intersectsAs<Segment, Capsule> },
+		{ &intersectsAs<Capsule, Circle>, &intersectsAs<Capsule, Rectangle>, &intersectsAs<Capsule, Segment>, &intersectsAs<Capsule, Capsule> },
+	};
+
+	return tests[static_cast<uint8_t>(first.type)][static_cast<uint8_t>(second.type)](first, second);
+}
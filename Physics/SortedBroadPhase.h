@@ -0,0 +1,199 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "RigidBody.h"
+#include "RadixSort.h"
+#include "Parallel.h"
+
+//
+// A broad phase for very large batches of bodies
+//
+// Rather than scattering bodies into grid cells, every body gets a cell key,
+// the (key, index) pairs are radix sorted, and each run of equal keys is a cell.
+// Writes all go through the sort, so memory is touched in order.
+//
+// Cells are (1 << cellShift) pixels square. For every pair within a cell's
+// reach to be found, cells must be at least as wide as the largest body.
+//
+// Meant for host batch runs; with PHYSICS_USE_THREADS defined the key and
+// sort passes are spread over several threads.
+//
+template< size_t CapacityValue >
+class SortedBroadPhase
+{
+public:
+	static constexpr size_t Capacity = CapacityValue;
+
+	using IndexType = uint32_t;
+	using KeyType = uint32_t;
+
+private:
+	// Fields
+	KeyType keys[Capacity];
+	IndexType indices[Capacity];
+	KeyType scratchKeys[Capacity];
+	IndexType scratchIndices[Capacity];
+
+	// Where each run of equal keys starts, with one extra at the end
+	IndexType runStarts[Capacity + 1];
+	size_t count = 0;
+	size_t runCount = 0;
+
+	uint8_t cellShift = 5;
+
+public:
+	constexpr size_t getCount(void) const
+	{
+		return this->count;
+	}
+
+	constexpr size_t getRunCount(void) const
+	{
+		return this->runCount;
+	}
+
+	constexpr uint8_t getCellShift(void) const
+	{
+		return this->cellShift;
+	}
+
+	void setCellShift(uint8_t cellShift)
+	{
+		this->cellShift = cellShift;
+	}
+
+	// Rows in the top half, columns in the bottom, so runs are in row order
+	KeyType getKey(Point2 position) const
+	{
+		const uint16_t column = static_cast<uint16_t>((position.x.getInteger() + 0x8000) >> this->cellShift);
+		const uint16_t row = static_cast<uint16_t>((position.y.getInteger() + 0x8000) >> this->cellShift);
+		return ((static_cast<KeyType>(row) << 16) | column);
+	}
+
+	void build(const RigidBody * bodies, size_t count)
+	{
+		this->count = clamp<size_t>(count, 0, Capacity);
+
+		const size_t threadCount = (this->count >= 16384) ? getThreadCount() : 1;
+
+		runOnThreads(threadCount, [&](size_t thread)
+		{
+			const size_t end = getChunkBegin(this->count, thread + 1, threadCount);
+			for(size_t i = getChunkBegin(this->count, thread, threadCount); i < end; ++i)
+			{
+				this->keys[i] = this->getKey(bodies[i].position);
+				this->indices[i] = static_cast<IndexType>(i);
+			}
+		});
+
+		radixSortParallel(this->keys, this->indices, this->scratchKeys, this->scratchIndices, this->count);
+
+		this->runCount = 0;
+		for(size_t i = 0; i < this->count; ++i)
+			if((i == 0) || (this->keys[i] != this->keys[i - 1]))
+			{
+				this->scratchKeys[this->runCount] = this->keys[i];
+				this->runStarts[this->runCount] = static_cast<IndexType>(i);
+				++this->runCount;
+			}
+
+		this->runStarts[this->runCount] = static_cast<IndexType>(this->count);
+	}
+
+	// Calls action(first, second) once for every pair of body indices
+	// in the same or neighbouring cells
+	// Only looks forwards, to the right and the row below, so no pair is repeated
+	template< typename Action >
+	void forEachPair(Action action) const
+	{
+		for(size_t run = 0; run < this->runCount; ++run)
+		{
+			const KeyType key = this->getRunKey(run);
+			const uint16_t column = static_cast<uint16_t>(key & 0xFFFF);
+			const uint16_t row = static_cast<uint16_t>(key >> 16);
+
+			this->forEachPairInRun(run, action);
+
+			// The cell to the right can only be the next run
+			if((column < 0xFFFF) && ((run + 1) < this->runCount) && (this->getRunKey(run + 1) == (key + 1)))
+				this->forEachPairBetweenRuns(run, run + 1, action);
+
+			if(row == 0xFFFF)
+				continue;
+
+			// The three cells below are consecutive keys, so they're consecutive runs
+			const KeyType belowFirst = ((static_cast<KeyType>(row + 1) << 16) | ((column > 0) ? (column - 1) : column));
+			const KeyType belowLast = ((static_cast<KeyType>(row + 1) << 16) | ((column < 0xFFFF) ? (column + 1) : column));
+
+			for(size_t other = this->findRun(belowFirst, run + 1); (other < this->runCount) && (this->getRunKey(other) <= belowLast); ++other)
+				this->forEachPairBetweenRuns(run, other, action);
+		}
+	}
+
+private:
+	// The unique keys are kept in the scratch keys once sorting is done
+	KeyType getRunKey(size_t run) const
+	{
+		return this->scratchKeys[run];
+	}
+
+	// First run at or after start whose key is no less than key
+	size_t findRun(KeyType key, size_t start) const
+	{
+		size_t low = start;
+		size_t high = this->runCount;
+
+		while(low < high)
+		{
+			const size_t middle = (low + ((high - low) / 2));
+
+			if(this->getRunKey(middle) < key)
+				low = (middle + 1);
+			else
+				high = middle;
+		}
+
+		return low;
+	}
+
+	template< typename Action >
+	void forEachPairInRun(size_t run, Action & action) const
+	{
+		const size_t end = this->runStarts[run + 1];
+
+		for(size_t i = this->runStarts[run]; i < end; ++i)
+			for(size_t j = (i + 1); j < end; ++j)
+				action(this->indices[i], this->indices[j]);
+	}
+
+	template< typename Action >
+	void forEachPairBetweenRuns(size_t run, size_t other, Action & action) const
+	{
+		const size_t end = this->runStarts[run + 1];
+		const size_t otherEnd = this->runStarts[other + 1];
+
+		for(size_t i = this->runStarts[run]; i < end; ++i)
+			for(size_t j = this->runStarts[other]; j < otherEnd; ++j)
+				action(this->indices[i], this->indices[j]);
+	}
+};
+
+template< size_t CapacityValue >
+constexpr size_t SortedBroadPhase<CapacityValue>::Capacity;
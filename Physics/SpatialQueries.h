@@ -0,0 +1,173 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "RigidBody.h"
+#include "BoundedHeap.h"
+
+//
+// Proximity queries over a UniformGrid
+//
+// Cells are searched in square rings spreading out from the query point.
+// Once a ring is finished, anything further out is at least
+// ring * cellSize away, so the search can stop as soon as
+// the current answer is closer than that.
+//
+// Distances are compared as WideNumber so long ranges can't overflow.
+//
+
+// Calls function(column, row) for each cell exactly ring cells away
+// from (column, row) that lies within the grid
+template< typename Grid, typename Function >
+void forEachCellInRing(uint8_t column, uint8_t row, uint8_t ring, Function function)
+{
+	const int16_t left = (column - ring);
+	const int16_t right = (column + ring);
+	const int16_t top = (row - ring);
+	const int16_t bottom = (row + ring);
+
+	for(int16_t y = top; y <= bottom; ++y)
+	{
+		if((y < 0) || (y >= Grid::Rows))
+			continue;
+
+		const bool isEdgeRow = ((y == top) || (y == bottom));
+		const int16_t step = (isEdgeRow || (ring == 0)) ? 1 : (right - left);
+
+		for(int16_t x = left; x <= right; x += step)
+			if((x >= 0) && (x < Grid::Columns))
+				function(static_cast<uint8_t>(x), static_cast<uint8_t>(y));
+	}
+}
+
+// Smallest possible square distance to any body beyond the given ring
+template< typename Grid >
+WideNumber getRingBound(const Grid & grid, uint8_t ring)
+{
+	const Number reach = Number(static_cast<int32_t>(ring) << grid.getCellShift());
+	return multiply(reach, reach);
+}
+
+template< typename Grid >
+constexpr uint8_t getMaximumRing(void)
+{
+	return (Grid::Columns > Grid::Rows) ? Grid::Columns : Grid::Rows;
+}
+
+// Returns the index of the body nearest to point, or Grid::None if there are none
+// ignore can be used to skip the body doing the asking
+template< typename Grid, size_t size >
+typename Grid::IndexType findNearest(const Grid & grid, const RigidBody (&bodies)[size], Point2 point, typename Grid::IndexType ignore = Grid::None)
+{
+	using IndexType = typename Grid::IndexType;
+
+	const uint8_t column = grid.getColumn(point.x);
+	const uint8_t row = grid.getRow(point.y);
+
+	// The ring bound only holds if the search starts inside the grid
+	const bool canStopEarly = grid.contains(point);
+
+	IndexType nearest = Grid::None;
+	WideNumber nearestDistance = MaxWideNumber;
+
+	for(uint8_t ring = 0; ring < getMaximumRing<Grid>(); ++ring)
+	{
+		forEachCellInRing<Grid>(column, row, ring, [&](uint8_t x, uint8_t y)
+		{
+			grid.forEachInCell(x, y, [&](IndexType index)
+			{
+				if(index == ignore)
+					return;
+
+				const WideNumber distance = distanceSquaredWide(point, bodies[index].position);
+				if(distance < nearestDistance)
+				{
+					nearestDistance = distance;
+					nearest = index;
+				}
+			});
+		});
+
+		if(canStopEarly && (nearest != Grid::None) && (nearestDistance <= getRingBound(grid, ring)))
+			break;
+	}
+
+	return nearest;
+}
+
+template< typename IndexType >
+struct NearestCandidate
+{
+	WideNumber distance;
+	IndexType index;
+};
+
+template< typename IndexType >
+struct FurthestCandidateFirst
+{
+	constexpr bool operator ()(const NearestCandidate<IndexType> & left, const NearestCandidate<IndexType> & right) const
+	{
+		return (left.distance > right.distance);
+	}
+};
+
+// Writes the indices of up to resultSize nearest bodies into results, nearest first
+// Returns the number of indices written
+template< typename Grid, size_t size, size_t resultSize >
+size_t findNearest(const Grid & grid, const RigidBody (&bodies)[size], Point2 point, typename Grid::IndexType (&results)[resultSize], typename Grid::IndexType ignore = Grid::None)
+{
+	using IndexType = typename Grid::IndexType;
+	using Candidate = NearestCandidate<IndexType>;
+
+	// Max-heap so the worst of the current best is always on top
+	BoundedHeap<Candidate, resultSize, FurthestCandidateFirst<IndexType>> heap;
+
+	const uint8_t column = grid.getColumn(point.x);
+	const uint8_t row = grid.getRow(point.y);
+	const bool canStopEarly = grid.contains(point);
+
+	for(uint8_t ring = 0; ring < getMaximumRing<Grid>(); ++ring)
+	{
+		forEachCellInRing<Grid>(column, row, ring, [&](uint8_t x, uint8_t y)
+		{
+			grid.forEachInCell(x, y, [&](IndexType index)
+			{
+				if(index == ignore)
+					return;
+
+				const Candidate candidate = { distanceSquaredWide(point, bodies[index].position), index };
+
+				if(!heap.isFull())
+					heap.push(candidate);
+				else if(candidate.distance < heap.getTop().distance)
+					heap.replaceTop(candidate);
+			});
+		});
+
+		if(canStopEarly && heap.isFull() && (heap.getTop().distance <= getRingBound(grid, ring)))
+			break;
+	}
+
+	// Popping a max-heap gives the furthest first, so fill from the back
+	const size_t count = heap.getCount();
+	for(size_t i = count; i > 0; --i)
+		results[i - 1] = heap.pop().index;
+
+	return count;
+}
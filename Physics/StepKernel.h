@@ -0,0 +1,190 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Vector.h"
+#include "Rectangle.h"
+#include "RigidBody.h"
+
+// Features a step kernel can be built with
+// Combined as bit flags
+// Enumerators rather than static members, so they need no definitions
+class StepFeatures
+{
+public:
+	enum : uint8_t
+	{
+		None = 0,
+
+		// Accelerate every body by the gravity vector
+		Gravity = (1 << 0),
+
+		// Apply friction on both axes, rather than just horizontally
+		TopDownFriction = (1 << 1),
+
+		// Lose energy bouncing off the top and bottom,
+		// and come to rest once slow enough
+		RestitutionFloor = (1 << 2),
+
+		// Leave one side and come back on the other, rather than bouncing
+		// Only horizontally if RestitutionFloor is also set
+		WrapAround = (1 << 3),
+
+		All = (Gravity | TopDownFriction | RestitutionFloor | WrapAround),
+		CombinationCount = (All + 1),
+	};
+};
+
+class StepParameters
+{
+public:
+	// Fields
+	Vector2 gravity;
+	Number friction;
+	Number restitution;
+	Number restitutionThreshold;
+
+	// Where a body's position is allowed to be
+	Rectangle bounds;
+};
+
+//
+// One step of a simple world, built for a fixed set of features
+//
+// The feature tests are all on compile-time constants,
+// so each specialisation's body loop has no mode branches left in it.
+// Pick one with getStepKernel once per frame.
+//
+template< uint8_t FeaturesValue, typename Integrator >
+class StepKernel
+{
+public:
+	static constexpr uint8_t Features = FeaturesValue;
+
+	static constexpr bool HasGravity = ((Features & StepFeatures::Gravity) != 0);
+	static constexpr bool HasTopDownFriction = ((Features & StepFeatures::TopDownFriction) != 0);
+	static constexpr bool HasRestitutionFloor = ((Features & StepFeatures::RestitutionFloor) != 0);
+	static constexpr bool HasWrapAround = ((Features & StepFeatures::WrapAround) != 0);
+
+public:
+	static void step(RigidBody * bodies, size_t count, const StepParameters & parameters)
+	{
+		const Vector2 acceleration = HasGravity ? parameters.gravity : Vector2(Number(0), Number(0));
+		const Vector2 damping = Vector2(parameters.friction, HasTopDownFriction ? parameters.friction : Number(1));
+
+		const Number left = parameters.bounds.getLeft();
+		const Number right = parameters.bounds.getRight();
+		const Number top = parameters.bounds.getTop();
+		const Number bottom = parameters.bounds.getBottom();
+
+		for(size_t i = 0; i < count; ++i)
+		{
+			RigidBody & body = bodies[i];
+
+			Integrator::integrateVelocity(body, acceleration, damping);
+
+			if(HasWrapAround)
+				wrap(body.position.x, left, right);
+			else
+				bounce(body.position.x, body.velocity.x, left, right);
+
+			if(HasRestitutionFloor)
+			{
+				if(body.position.y < top)
+				{
+					body.position.y = top;
+					body.velocity.y = restitute(body.velocity.y, parameters);
+				}
+
+				if(body.position.y > bottom)
+				{
+					body.position.y = bottom;
+					body.velocity.y = restitute(body.velocity.y, parameters);
+				}
+			}
+			else if(HasWrapAround)
+				wrap(body.position.y, top, bottom);
+			else
+				bounce(body.position.y, body.velocity.y, top, bottom);
+
+			Integrator::integratePosition(body);
+		}
+	}
+
+private:
+	static void bounce(Number & position, Number & velocity, Number minimum, Number maximum)
+	{
+		if(position < minimum)
+		{
+			position = minimum;
+			velocity = -velocity;
+		}
+
+		if(position > maximum)
+		{
+			position = maximum;
+			velocity = -velocity;
+		}
+	}
+
+	static void wrap(Number & position, Number minimum, Number maximum)
+	{
+		if(position < minimum)
+			position += (maximum - minimum);
+
+		if(position > maximum)
+			position -= (maximum - minimum);
+	}
+
+	static Number restitute(Number velocity, const StepParameters & parameters)
+	{
+		return (velocity > parameters.restitutionThreshold) ? (-velocity * parameters.restitution) : Number(0);
+	}
+};
+
+template< uint8_t FeaturesValue, typename Integrator >
+constexpr uint8_t StepKernel<FeaturesValue, Integrator>::Features;
+
+using StepFunction = void (*)(RigidBody * bodies, size_t count, const StepParameters & parameters);
+
+// Picks the kernel for a combination of StepFeatures from a table indexed by the flags
+template< typename Integrator >
+StepFunction getStepKernel(uint8_t features)
+{
+	static const StepFunction kernels[StepFeatures::CombinationCount] =
+	{
+		&StepKernel<0, Integrator>::step,
+		&StepKernel<1, Integrator>::step,
+		&StepKernel<2, Integrator>::step,
+		&StepKernel<3, Integrator>::step,
+		&StepKernel<4, Integrator>::step,
+		&StepKernel<5, Integrator>::step,
+		&StepKernel<6, Integrator>::step,
+		&StepKernel<7, Integrator>::step,
+		&StepKernel<8, Integrator>::step,
+		&StepKernel<9, Integrator>::step,
+		&StepKernel<10, Integrator>::step,
+		&StepKernel<11, Integrator>::step,
+		&StepKernel<12, Integrator>::step,
+		&StepKernel<13, Integrator>::step,
+		&StepKernel<14, Integrator>::step,
+		&StepKernel<15, Integrator>::step,
+	};
+
+	return kernels[features & StepFeatures::All];
+}
@@ -0,0 +1,236 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "Rectangle.h"
+#include "Circle.h"
+
+//
+// Destructible terrain stored as one bit per pixel
+//
+// Each row is packed into 32-bit words, leftmost pixel in the lowest bit,
+// so overlap tests check up to 32 pixels at once.
+// Anything outside the mask counts as empty.
+//
+template< uint16_t WidthValue, uint16_t HeightValue >
+class TerrainMask
+{
+public:
+	static constexpr uint16_t Width = WidthValue;
+	static constexpr uint16_t Height = HeightValue;
+	static constexpr uint16_t WordsPerRow = ((Width + 31) / 32);
+
+private:
+	// Fields
+	uint32_t words[Height][WordsPerRow];
+
+public:
+	// Constructors
+	TerrainMask(void)
+	{
+		this->clear();
+	}
+
+	void clear(void)
+	{
+		for(uint16_t y = 0; y < Height; ++y)
+			for(uint16_t word = 0; word < WordsPerRow; ++word)
+				this->words[y][word] = 0;
+	}
+
+	bool getPixel(int16_t x, int16_t y) const
+	{
+		if((x < 0) || (x >= Width) || (y < 0) || (y >= Height))
+			return false;
+
+		return ((this->words[y][x >> 5] & (UINT32_C(1) << (x & 31))) != 0);
+	}
+
+	void setPixel(int16_t x, int16_t y, bool solid)
+	{
+		if((x < 0) || (x >= Width) || (y < 0) || (y >= Height))
+			return;
+
+		if(solid)
+			this->words[y][x >> 5] |= (UINT32_C(1) << (x & 31));
+		else
+			this->words[y][x >> 5] &= ~(UINT32_C(1) << (x & 31));
+	}
+
+	// Returns true if any pixel from left to right inclusive on row y is solid
+	bool testSpan(int16_t y, int16_t left, int16_t right) const
+	{
+		if(!clampSpan(y, left, right))
+			return false;
+
+		const uint16_t firstWord = (left >> 5);
+		const uint16_t lastWord = (right >> 5);
+
+		for(uint16_t word = firstWord; word <= lastWord; ++word)
+		{
+			const uint32_t mask = getSpanMask(word, left, right);
+			if((this->words[y][word] & mask) != 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	// Sets every pixel from left to right inclusive on row y
+	void fillSpan(int16_t y, int16_t left, int16_t right, bool solid)
+	{
+		if(!clampSpan(y, left, right))
+			return;
+
+		const uint16_t firstWord = (left >> 5);
+		const uint16_t lastWord = (right >> 5);
+
+		for(uint16_t word = firstWord; word <= lastWord; ++word)
+		{
+			const uint32_t mask = getSpanMask(word, left, right);
+			if(solid)
+				this->words[y][word] |= mask;
+			else
+				this->words[y][word] &= ~mask;
+		}
+	}
+
+	// Returns true if the rectangle overlaps any solid pixel
+	bool intersects(Rectangle rectangle) const
+	{
+		const int16_t left = toPixel(rectangle.getLeft());
+		const int16_t right = toPixel(rectangle.getRight());
+		const int16_t top = toPixel(rectangle.getTop());
+		const int16_t bottom = toPixel(rectangle.getBottom());
+
+		for(int16_t y = top; y <= bottom; ++y)
+			if(this->testSpan(y, left, right))
+				return true;
+
+		return false;
+	}
+
+	// Returns true if the circle overlaps any solid pixel
+	// The circle is tested one row at a time as a horizontal span
+	bool intersects(Circle circle) const
+	{
+		const int16_t centreX = toPixel(circle.getX());
+		const int16_t centreY = toPixel(circle.getY());
+		const int16_t radius = static_cast<int16_t>(circle.radius.getInteger());
+
+		for(int16_t offset = -radius; offset <= radius; ++offset)
+		{
+			const int16_t halfWidth = getHalfWidth(radius, offset);
+			if(this->testSpan(centreY + offset, centreX - halfWidth, centreX + halfWidth))
+				return true;
+		}
+
+		return false;
+	}
+
+	// Clears every pixel inside the circle, e.g. for an explosion
+	void carve(Circle circle)
+	{
+		this->fill(circle, false);
+	}
+
+	void fill(Circle circle, bool solid)
+	{
+		const int16_t centreX = toPixel(circle.getX());
+		const int16_t centreY = toPixel(circle.getY());
+		const int16_t radius = static_cast<int16_t>(circle.radius.getInteger());
+
+		for(int16_t offset = -radius; offset <= radius; ++offset)
+		{
+			const int16_t halfWidth = getHalfWidth(radius, offset);
+			this->fillSpan(centreY + offset, centreX - halfWidth, centreX + halfWidth, solid);
+		}
+	}
+
+	// Estimates the surface normal at a point by comparing how many
+	// solid pixels lie on each side of it in a 5x5 neighbourhood
+	// Points away from the solid side, and is zero in open space or deep inside
+	Vector2 getNormal(Point2 point) const
+	{
+		const int16_t x = toPixel(point.x);
+		const int16_t y = toPixel(point.y);
+
+		int16_t normalX = 0;
+		int16_t normalY = 0;
+
+		for(int16_t offsetY = -2; offsetY <= 2; ++offsetY)
+			for(int16_t offsetX = -2; offsetX <= 2; ++offsetX)
+				if(this->getPixel(x + offsetX, y + offsetY))
+				{
+					normalX -= offsetX;
+					normalY -= offsetY;
+				}
+
+		return Vector2(Number(normalX), Number(normalY)).getNormalisedFast();
+	}
+
+private:
+	static int16_t toPixel(Number value)
+	{
+		return static_cast<int16_t>(floorFixed(value).getInteger());
+	}
+
+	// Half the width of a circle's row, offset rows from its centre
+	static int16_t getHalfWidth(int16_t radius, int16_t offset)
+	{
+		return static_cast<int16_t>(integerSquareRoot(static_cast<uint64_t>((radius * radius) - (offset * offset))));
+	}
+
+	// Returns false if the span misses the mask entirely
+	static bool clampSpan(int16_t y, int16_t & left, int16_t & right)
+	{
+		if((y < 0) || (y >= Height) || (right < 0) || (left >= Width) || (left > right))
+			return false;
+
+		if(left < 0)
+			left = 0;
+
+		if(right >= Width)
+			right = (Width - 1);
+
+		return true;
+	}
+
+	// The bits of the given word that lie between left and right inclusive
+	static uint32_t getSpanMask(uint16_t word, int16_t left, int16_t right)
+	{
+		const int16_t wordLeft = (word * 32);
+		const uint8_t first = (left > wordLeft) ? (left - wordLeft) : 0;
+		const uint8_t last = (right < (wordLeft + 31)) ? (right - wordLeft) : 31;
+
+		const uint32_t upper = (last == 31) ? UINT32_MAX : ((UINT32_C(1) << (last + 1)) - 1);
+		const uint32_t lower = ((UINT32_C(1) << first) - 1);
+		return (upper & ~lower);
+	}
+};
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint16_t TerrainMask<WidthValue, HeightValue>::Width;
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint16_t TerrainMask<WidthValue, HeightValue>::Height;
+
+template< uint16_t WidthValue, uint16_t HeightValue >
+constexpr uint16_t TerrainMask<WidthValue, HeightValue>::WordsPerRow;
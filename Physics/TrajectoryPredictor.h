@@ -0,0 +1,79 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "Size.h"
+#include "Rectangle.h"
+#include "RigidBody.h"
+#include "Integrator.h"
+
+class TrajectoryPrediction
+{
+public:
+	// An enumerator rather than a static member, so it needs no definition
+	enum : size_t { None = SIZE_MAX };
+
+public:
+	// Fields
+	size_t pointCount = 0;
+
+	// Index of the static rectangle that was hit, or None
+	size_t hitIndex = None;
+
+public:
+	constexpr bool hasHit(void) const
+	{
+		return (this->hitIndex != None);
+	}
+};
+
+//
+// Predicts where a single body will go, without stepping the rest of the world
+//
+// Only gravity, damping and static geometry are taken into account,
+// other bodies are ignored. The body is copied, so the real one is untouched.
+//
+// One point is written per step, until the buffer is full or the body
+// hits a static rectangle, in which case the hit position is the last point.
+//
+template< typename Integrator = SemiImplicitEulerIntegrator, size_t staticCount, size_t pointCount >
+TrajectoryPrediction predictTrajectory(RigidBody body, Size2 size, Vector2 acceleration, Vector2 damping, const Rectangle (&statics)[staticCount], Point2 (&points)[pointCount])
+{
+	TrajectoryPrediction result;
+
+	for(size_t step = 0; step < pointCount; ++step)
+	{
+		Integrator::integrateVelocity(body, acceleration, damping);
+		Integrator::integratePosition(body);
+
+		points[step] = body.position;
+		result.pointCount = (step + 1);
+
+		const Rectangle bounds = Rectangle(body.position, size);
+		for(size_t i = 0; i < staticCount; ++i)
+			if(intersects(bounds, statics[i]))
+			{
+				result.hitIndex = i;
+				return result;
+			}
+	}
+
+	return result;
+}
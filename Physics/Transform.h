@@ -0,0 +1,130 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "Vector.h"
+#include "Matrix.h"
+
+// On hosts built with SSE4.1, transformPoints does two points at a time
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+//
+// A rotation and scale followed by a translation
+//
+// Each transformed coordinate is summed in a WideNumber,
+// translation included, and rounded once
+//
+class Transform2
+{
+public:
+	// Fields
+	Matrix2 linear = Matrix2::identity();
+	Vector2 translation = Vector2(Number(0), Number(0));
+
+public:
+	// Constructors
+	constexpr Transform2(void) = default;
+	constexpr Transform2(const Matrix2 & linear, Vector2 translation) : linear(linear), translation(translation) {}
+
+	static constexpr Transform2 identity(void)
+	{
+		return Transform2(Matrix2::identity(), Vector2(Number(0), Number(0)));
+	}
+
+	static constexpr Transform2 translate(Vector2 translation)
+	{
+		return Transform2(Matrix2::identity(), translation);
+	}
+
+	// Rotate by the angle with the given cosine and sine, scale evenly, then translate
+	static constexpr Transform2 rotateScaleTranslate(Number cosine, Number sine, Number scale, Vector2 translation)
+	{
+		return Transform2(Matrix2(narrow(multiply(cosine, scale)), narrow(multiply(sine, scale)), narrow(multiply(-sine, scale)), narrow(multiply(cosine, scale))), translation);
+	}
+
+	constexpr Vector2 transformVector(Vector2 vector) const
+	{
+		return this->linear.transform(vector);
+	}
+
+	constexpr Point2 transformPoint(Point2 point) const
+	{
+		return Point2(
+			narrow(multiply(this->linear.m00, point.x) + multiply(this->linear.m01, point.y) + static_cast<WideNumber>(this->translation.x)),
+			narrow(multiply(this->linear.m10, point.x) + multiply(this->linear.m11, point.y) + static_cast<WideNumber>(this->translation.y)));
+	}
+
+	// Transforms count points from input into output
+	// The two may be the same array
+	// The SSE4.1 path wraps rather than saturates if a result is out of range,
+	// otherwise both paths give identical results
+	void transformPoints(const Point2 * input, Point2 * output, size_t count) const
+	{
+		size_t index = 0;
+
+#if defined(__SSE4_1__)
+		static_assert(sizeof(Point2) == (2 * sizeof(int32_t)), "Point2 must be two packed 32-bit values");
+
+		// _mm_mul_epi32 multiplies the even lanes, giving 64-bit products
+		const __m128i m00 = _mm_set1_epi32(this->linear.m00.getInternal());
+		const __m128i m01 = _mm_set1_epi32(this->linear.m01.getInternal());
+		const __m128i m10 = _mm_set1_epi32(this->linear.m10.getInternal());
+		const __m128i m11 = _mm_set1_epi32(this->linear.m11.getInternal());
+		const __m128i translationX = _mm_set1_epi64x(static_cast<WideNumber>(this->translation.x).getInternal());
+		const __m128i translationY = _mm_set1_epi64x(static_cast<WideNumber>(this->translation.y).getInternal());
+		const __m128i one = _mm_set1_epi64x(1);
+
+		constexpr int roundingShift = (WideNumber::FractionSize - Number::FractionSize - 1);
+
+		for(; (index + 2) <= count; index += 2)
+		{
+			// x0 y0 x1 y1
+			const __m128i points = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&input[index]));
+
+			// y0 - y1 -, so the y values sit in the even lanes too
+			const __m128i ys = _mm_srli_epi64(points, 32);
+
+			__m128i x = _mm_add_epi64(_mm_add_epi64(_mm_mul_epi32(points, m00), _mm_mul_epi32(ys, m01)), translationX);
+			__m128i y = _mm_add_epi64(_mm_add_epi64(_mm_mul_epi32(points, m10), _mm_mul_epi32(ys, m11)), translationY);
+
+			// Round half up, as narrow does
+			// Only the low 32 bits are kept, so logical shifts do as well as arithmetic ones
+			x = _mm_srli_epi64(_mm_add_epi64(_mm_srli_epi64(x, roundingShift), one), 1);
+			y = _mm_srli_epi64(_mm_add_epi64(_mm_srli_epi64(y, roundingShift), one), 1);
+
+			// Put y back in the odd lanes and store x0 y0 x1 y1
+			const __m128i result = _mm_blend_epi16(x, _mm_slli_epi64(y, 32), 0xCC);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(&output[index]), result);
+		}
+#endif
+
+		for(; index < count; ++index)
+			output[index] = this->transformPoint(input[index]);
+	}
+};
+
+// Composing two transforms applies right first, then left
+inline constexpr Transform2 operator *(const Transform2 & left, const Transform2 & right)
+{
+	return Transform2(left.linear * right.linear, Vector2(
+		narrow(multiply(left.linear.m00, right.translation.x) + multiply(left.linear.m01, right.translation.y) + static_cast<WideNumber>(left.translation.x)),
+		narrow(multiply(left.linear.m10, right.translation.x) + multiply(left.linear.m11, right.translation.y) + static_cast<WideNumber>(left.translation.y))));
+}
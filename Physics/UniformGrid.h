@@ -0,0 +1,249 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Point.h"
+#include "RigidBody.h"
+
+// A uniform grid of square cells over the play area
+// Each cell holds an intrusive doubly-linked list of body indices
+// Cell size is a runtime power of two so that it can be retuned
+//
+// The grid can be rebuilt from scratch every step, or kept up to date
+// with update, which only touches bodies that moved to another cell
+template< uint8_t ColumnsValue, uint8_t RowsValue, size_t CapacityValue >
+class UniformGrid
+{
+public:
+	static constexpr uint8_t Columns = ColumnsValue;
+	static constexpr uint8_t Rows = RowsValue;
+	static constexpr size_t Capacity = CapacityValue;
+	static constexpr size_t CellCount = (Columns * Rows);
+
+	using IndexType = uint16_t;
+	static constexpr IndexType None = 0xFFFF;
+
+	static_assert(Capacity < None, "UniformGrid capacity is too large for its index type");
+	static_assert(CellCount < None, "UniformGrid has too many cells for its index type");
+
+private:
+	// Fields
+	IndexType cellHeads[CellCount];
+	IndexType nextIndices[Capacity];
+	IndexType previousIndices[Capacity];
+
+	// The cell each body is in, or None
+	IndexType bodyCells[Capacity];
+
+	uint8_t cellShift = 5;
+
+public:
+	// Constructors
+	UniformGrid(void)
+	{
+		this->clear();
+	}
+
+	UniformGrid(uint8_t cellShift) : cellShift(cellShift)
+	{
+		this->clear();
+	}
+
+	constexpr uint8_t getCellShift(void) const
+	{
+		return this->cellShift;
+	}
+
+	constexpr uint16_t getCellSize(void) const
+	{
+		return (1 << this->cellShift);
+	}
+
+	// Changing the cell size invalidates the contents
+	void setCellShift(uint8_t cellShift)
+	{
+		this->cellShift = cellShift;
+		this->clear();
+	}
+
+	// Out of range coordinates are clamped to the edge cells
+	uint8_t getColumn(Number x) const
+	{
+		const int32_t column = (x.getInternal() >> (Number::FractionSize + this->cellShift));
+		return (column < 0) ? 0 : (column >= Columns) ? (Columns - 1) : static_cast<uint8_t>(column);
+	}
+
+	uint8_t getRow(Number y) const
+	{
+		const int32_t row = (y.getInternal() >> (Number::FractionSize + this->cellShift));
+		return (row < 0) ? 0 : (row >= Rows) ? (Rows - 1) : static_cast<uint8_t>(row);
+	}
+
+	static constexpr size_t getCellIndex(uint8_t column, uint8_t row)
+	{
+		return ((row * Columns) + column);
+	}
+
+	size_t getCellIndex(Point2 point) const
+	{
+		return getCellIndex(this->getColumn(point.x), this->getRow(point.y));
+	}
+
+	// Returns true if the point lies inside the area covered by the cells
+	bool contains(Point2 point) const
+	{
+		const int32_t column = (point.x.getInternal() >> (Number::FractionSize + this->cellShift));
+		const int32_t row = (point.y.getInternal() >> (Number::FractionSize + this->cellShift));
+		return (column >= 0) && (column < Columns) && (row >= 0) && (row < Rows);
+	}
+
+	IndexType getCellHead(uint8_t column, uint8_t row) const
+	{
+		return this->cellHeads[getCellIndex(column, row)];
+	}
+
+	IndexType getNext(IndexType index) const
+	{
+		return this->nextIndices[index];
+	}
+
+	// Returns None if the body isn't in the grid
+	IndexType getBodyCell(IndexType index) const
+	{
+		return this->bodyCells[index];
+	}
+
+	void clear(void)
+	{
+		for(size_t i = 0; i < CellCount; ++i)
+			this->cellHeads[i] = None;
+
+		for(size_t i = 0; i < Capacity; ++i)
+			this->bodyCells[i] = None;
+	}
+
+	// The body must not already be in the grid
+	void insert(IndexType index, Point2 position)
+	{
+		this->link(index, static_cast<IndexType>(this->getCellIndex(position)));
+	}
+
+	void remove(IndexType index)
+	{
+		if(this->bodyCells[index] != None)
+			this->unlink(index);
+	}
+
+	// Moves a body to the cell its new position is in
+	// Does nothing if it hasn't changed cell
+	void move(IndexType index, Point2 position)
+	{
+		const IndexType cell = static_cast<IndexType>(this->getCellIndex(position));
+
+		if(this->bodyCells[index] == cell)
+			return;
+
+		this->remove(index);
+		this->link(index, cell);
+	}
+
+	// Brings the grid up to date without rebuilding it
+	template< size_t size >
+	void update(const RigidBody (&bodies)[size])
+	{
+		static_assert(size <= Capacity, "UniformGrid is too small for the body array");
+
+		for(size_t i = 0; i < size; ++i)
+			this->move(static_cast<IndexType>(i), bodies[i].position);
+	}
+
+	// As above, but sleeping bodies haven't moved, so they're skipped entirely
+	template< size_t size >
+	void update(const RigidBody (&bodies)[size], const SleepState (&sleepStates)[size])
+	{
+		static_assert(size <= Capacity, "UniformGrid is too small for the body array");
+
+		for(size_t i = 0; i < size; ++i)
+			if(!sleepStates[i].isSleeping())
+				this->move(static_cast<IndexType>(i), bodies[i].position);
+	}
+
+	template< size_t size >
+	void rebuild(const RigidBody (&bodies)[size])
+	{
+		static_assert(size <= Capacity, "UniformGrid is too small for the body array");
+
+		this->clear();
+		for(size_t i = 0; i < size; ++i)
+			this->insert(static_cast<IndexType>(i), bodies[i].position);
+	}
+
+	// Calls function(index) for every body in the given cell
+	template< typename Function >
+	void forEachInCell(uint8_t column, uint8_t row, Function function) const
+	{
+		for(IndexType index = this->getCellHead(column, row); index != None; index = this->nextIndices[index])
+			function(index);
+	}
+
+private:
+	void link(IndexType index, IndexType cell)
+	{
+		const IndexType head = this->cellHeads[cell];
+
+		this->nextIndices[index] = head;
+		this->previousIndices[index] = None;
+
+		if(head != None)
+			this->previousIndices[head] = index;
+
+		this->cellHeads[cell] = index;
+		this->bodyCells[index] = cell;
+	}
+
+	void unlink(IndexType index)
+	{
+		const IndexType next = this->nextIndices[index];
+		const IndexType previous = this->previousIndices[index];
+
+		if(previous != None)
+			this->nextIndices[previous] = next;
+		else
+			this->cellHeads[this->bodyCells[index]] = next;
+
+		if(next != None)
+			this->previousIndices[next] = previous;
+
+		this->bodyCells[index] = None;
+	}
+};
+
+template< uint8_t ColumnsValue, uint8_t RowsValue, size_t CapacityValue >
+constexpr uint8_t UniformGrid<ColumnsValue, RowsValue, CapacityValue>::Columns;
+
+template< uint8_t ColumnsValue, uint8_t RowsValue, size_t CapacityValue >
+constexpr uint8_t UniformGrid<ColumnsValue, RowsValue, CapacityValue>::Rows;
+
+template< uint8_t ColumnsValue, uint8_t RowsValue, size_t CapacityValue >
+constexpr size_t UniformGrid<ColumnsValue, RowsValue, CapacityValue>::Capacity;
+
+template< uint8_t ColumnsValue, uint8_t RowsValue, size_t CapacityValue >
+constexpr size_t UniformGrid<ColumnsValue, RowsValue, CapacityValue>::CellCount;
+
+template< uint8_t ColumnsValue, uint8_t RowsValue, size_t CapacityValue >
+constexpr typename UniformGrid<ColumnsValue, RowsValue, CapacityValue>::IndexType UniformGrid<ColumnsValue, RowsValue, CapacityValue>::None;
@@ -33,12 +33,44 @@ public:
 	constexpr Vector2(int16_t x, int16_t y) : x(x), y(y) {}
 	constexpr Vector2(Number x, Number y) : x(x), y(y) {}
 	
-	// Can't do a regular get magnitude without using float because
-	// I don't have a fixed point sqrt
 	constexpr NumberU getMagnitudeSquared(void) const
 	{
 		return fromSigned((x * x) + (y * y));
 	}
+
+	// Widened so that long vectors don't overflow
+	// The one exception is both components being exactly Number's MinValue,
+	// whose squares are 2^30 each and together just too big for WideNumber
+	constexpr WideNumber getMagnitudeSquaredWide(void) const
+	{
+		return multiply(x, x) + multiply(y, y);
+	}
+
+	// Needs a square root, so avoid it when the squared magnitude will do
+	Number getMagnitude(void) const
+	{
+		return squareRoot(this->getMagnitudeSquaredWide());
+	}
+
+	// Alpha max plus beta min approximation, no square root needed
+	// Always within about 4% of the true magnitude
+	constexpr Number getMagnitudeFast(void) const
+	{
+		return getMagnitudeFast(absFixed(this->x), absFixed(this->y));
+	}
+
+	// Unit length vector pointing the same way, within about 4%
+	// Zero vectors stay zero
+	Vector2 getNormalisedFast(void) const
+	{
+		const Number magnitude = this->getMagnitudeFast();
+
+		if(magnitude <= 0)
+			return *this;
+
+		const Number inverse = (1 / magnitude);
+		return Vector2(this->x * inverse, this->y * inverse);
+	}
 	
 	Vector2 & operator +=(Vector2 other)
 	{
@@ -90,6 +122,15 @@ public:
 		this->y = -this->y;
 		return *this;
 	}
+
+private:
+	// 0.96043 * max + 0.39782 * min
+	static constexpr Number getMagnitudeFast(Number absoluteX, Number absoluteY)
+	{
+		return (absoluteX > absoluteY) ?
+			((absoluteX * Number(0.96043)) + (absoluteY * Number(0.39782))) :
+			((absoluteY * Number(0.96043)) + (absoluteX * Number(0.39782)));
+	}
 };
 
 inline constexpr bool operator ==(Vector2 left, Vector2 right)
@@ -133,6 +174,61 @@ inline constexpr Vector2 operator /(Vector2 vector, Number factor)
 	return vector * (1 / factor);
 }
 
+//
+// Products
+//
+// dot and cross round the widened result once and saturate,
+// rather than wrapping like multiplying Numbers directly.
+//
+// Each widened product is at most 2^30 in size, and WideNumber holds just under
+// 2^31, so a difference of two products can't overflow and crossWide is always
+// exact. A sum can reach 2^31, so dotWide overflows in exactly one case:
+// when both products are Number's MinValue times itself, meaning every
+// component of both vectors is MinValue. Anything else is exact.
+//
+
+inline constexpr WideNumber dotWide(Vector2 left, Vector2 right)
+{
+	return multiply(left.x, right.x) + multiply(left.y, right.y);
+}
+
+inline constexpr Number dot(Vector2 left, Vector2 right)
+{
+	return narrow(dotWide(left, right));
+}
+
+// Positive if right is clockwise from left on screen, since y points down
+inline constexpr WideNumber crossWide(Vector2 left, Vector2 right)
+{
+	return multiply(left.x, right.y) - multiply(left.y, right.x);
+}
+
+inline constexpr Number cross(Vector2 left, Vector2 right)
+{
+	return narrow(crossWide(left, right));
+}
+
+// The vector turned a quarter turn clockwise on screen
+inline constexpr Vector2 perpendicular(Vector2 vector)
+{
+	return Vector2(-vector.y, vector.x);
+}
+
+// How many lengths of onto the projection of vector onto it is
+// Zero length vectors saturate
+inline constexpr Number getProjectionFactor(Vector2 vector, Vector2 onto)
+{
+	return divide(dotWide(vector, onto), onto.getMagnitudeSquaredWide());
+}
+
+// The part of vector pointing along onto
+inline constexpr Vector2 projectOnto(Vector2 vector, Vector2 onto)
+{
+	return Vector2(
+		narrow(multiply(onto.x, getProjectionFactor(vector, onto))),
+		narrow(multiply(onto.y, getProjectionFactor(vector, onto))));
+}
+
 // Dividing a vector by a factor scales the vector
 /*inline constexpr Vector2 operator /(Vector2 vector, NumberU factor)
 {
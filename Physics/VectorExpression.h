@@ -0,0 +1,299 @@
+/*
+   Copyright (C) 2018 Pharap (@Pharap)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include "Common.h"
+#include "Vector.h"
+#include "Point.h"
+
+//
+// Expression templates for Vector2 and Point2 arithmetic
+//
+// The ordinary operators round to a Number after every step, so something
+// like position + velocity * dt + acceleration * halfDtSquared rounds three
+// times. Lifting the operands with wide() instead builds the whole expression
+// up as a type, which is evaluated one component at a time in a WideNumber
+// and rounded once at the end:
+//
+//   const Point2 next = (wide(position) + wide(velocity) * dt + wide(acceleration) * halfDtSquared);
+//
+// Each scaled term is an exact widened product. Scaling an already scaled
+// expression multiplies the two factors together first, which does round.
+// The ordinary operators still round as before, so anything not lifted with
+// wide() is rounded before it joins the expression.
+//
+
+// What adding or subtracting the two kinds of expression gives
+// Anything left undefined doesn't make sense, like adding two points
+template< typename Left, typename Right >
+class SumResult;
+
+template<>
+class SumResult<Vector2, Vector2>
+{
+public:
+	using Type = Vector2;
+};
+
+template<>
+class SumResult<Point2, Vector2>
+{
+public:
+	using Type = Point2;
+};
+
+template<>
+class SumResult<Vector2, Point2>
+{
+public:
+	using Type = Point2;
+};
+
+template< typename Left, typename Right >
+class DifferenceResult;
+
+template<>
+class DifferenceResult<Vector2, Vector2>
+{
+public:
+	using Type = Vector2;
+};
+
+template<>
+class DifferenceResult<Point2, Vector2>
+{
+public:
+	using Type = Point2;
+};
+
+template<>
+class DifferenceResult<Point2, Point2>
+{
+public:
+	using Type = Vector2;
+};
+
+// Only vectors can be scaled
+template< typename Operand >
+class ScaleResult;
+
+template<>
+class ScaleResult<Vector2>
+{
+public:
+	using Type = Vector2;
+};
+
+// Every expression derives from this, so the operators can pick them out
+// Derived must provide getX, getY, getScaledX and getScaledY
+template< typename Derived, typename Result >
+class VectorExpression
+{
+public:
+	using ResultType = Result;
+
+public:
+	constexpr const Derived & getDerived(void) const
+	{
+		return static_cast<const Derived &>(*this);
+	}
+
+	// Rounds each component once, saturating if it's out of range
+	constexpr Result evaluate(void) const
+	{
+		return Result(narrow(this->getDerived().getX()), narrow(this->getDerived().getY()));
+	}
+
+	constexpr operator Result(void) const
+	{
+		return this->evaluate();
+	}
+};
+
+template< typename Value >
+class TermExpression : public VectorExpression<TermExpression<Value>, Value>
+{
+private:
+	Value value;
+
+public:
+	constexpr explicit TermExpression(Value value) : value(value) {}
+
+	constexpr WideNumber getX(void) const
+	{
+		return static_cast<WideNumber>(this->value.x);
+	}
+
+	constexpr WideNumber getY(void) const
+	{
+		return static_cast<WideNumber>(this->value.y);
+	}
+
+	constexpr WideNumber getScaledX(Number factor) const
+	{
+		return multiply(this->value.x, factor);
+	}
+
+	constexpr WideNumber getScaledY(Number factor) const
+	{
+		return multiply(this->value.y, factor);
+	}
+};
+
+template< typename Left, typename Right >
+class SumExpression : public VectorExpression<SumExpression<Left, Right>, typename SumResult<typename Left::ResultType, typename Right::ResultType>::Type>
+{
+private:
+	Left left;
+	Right right;
+
+public:
+	constexpr SumExpression(const Left & left, const Right & right) : left(left), right(right) {}
+
+	constexpr WideNumber getX(void) const
+	{
+		return (this->left.getX() + this->right.getX());
+	}
+
+	constexpr WideNumber getY(void) const
+	{
+		return (this->left.getY() + this->right.getY());
+	}
+
+	constexpr WideNumber getScaledX(Number factor) const
+	{
+		return (this->left.getScaledX(factor) + this->right.getScaledX(factor));
+	}
+
+	constexpr WideNumber getScaledY(Number factor) const
+	{
+		return (this->left.getScaledY(factor) + this->right.getScaledY(factor));
+	}
+};
+
+template< typename Left, typename Right >
+class DifferenceExpression : public VectorExpression<DifferenceExpression<Left, Right>, typename DifferenceResult<typename Left::ResultType, typename Right::ResultType>::Type>
+{
+private:
+	Left left;
+	Right right;
+
+public:
+	constexpr DifferenceExpression(const Left & left, const Right & right) : left(left), right(right) {}
+
+	constexpr WideNumber getX(void) const
+	{
+		return (this->left.getX() - this->right.getX());
+	}
+
+	constexpr WideNumber getY(void) const
+	{
+		return (this->left.getY() - this->right.getY());
+	}
+
+	constexpr WideNumber getScaledX(Number factor) const
+	{
+		return (this->left.getScaledX(factor) - this->right.getScaledX(factor));
+	}
+
+	constexpr WideNumber getScaledY(Number factor) const
+	{
+		return (this->left.getScaledY(factor) - this->right.getScaledY(factor));
+	}
+};
+
+template< typename Operand >
+class ScaleExpression : public VectorExpression<ScaleExpression<Operand>, typename ScaleResult<typename Operand::ResultType>::Type>
+{
+private:
+	Operand operand;
+	Number factor;
+
+public:
+	constexpr ScaleExpression(const Operand & operand, Number factor) : operand(operand), factor(factor) {}
+
+	constexpr WideNumber getX(void) const
+	{
+		return this->operand.getScaledX(this->factor);
+	}
+
+	constexpr WideNumber getY(void) const
+	{
+		return this->operand.getScaledY(this->factor);
+	}
+
+	constexpr WideNumber getScaledX(Number factor) const
+	{
+		return this->operand.getScaledX(this->factor * factor);
+	}
+
+	constexpr WideNumber getScaledY(Number factor) const
+	{
+		return this->operand.getScaledY(this->factor * factor);
+	}
+};
+
+//
+// Building expressions
+//
+
+// Lifts a vector or point into an expression
+inline constexpr TermExpression<Vector2> wide(Vector2 vector)
+{
+	return TermExpression<Vector2>(vector);
+}
+
+inline constexpr TermExpression<Point2> wide(Point2 point)
+{
+	return TermExpression<Point2>(point);
+}
+
+template< typename Left, typename LeftResult, typename Right, typename RightResult >
+constexpr SumExpression<Left, Right> operator +(const VectorExpression<Left, LeftResult> & left, const VectorExpression<Right, RightResult> & right)
+{
+	return SumExpression<Left, Right>(left.getDerived(), right.getDerived());
+}
+
+template< typename Left, typename LeftResult, typename Right, typename RightResult >
+constexpr DifferenceExpression<Left, Right> operator -(const VectorExpression<Left, LeftResult> & left, const VectorExpression<Right, RightResult> & right)
+{
+	return DifferenceExpression<Left, Right>(left.getDerived(), right.getDerived());
+}
+
+template< typename Operand, typename Result >
+constexpr ScaleExpression<Operand> operator *(const VectorExpression<Operand, Result> & operand, Number factor)
+{
+	return ScaleExpression<Operand>(operand.getDerived(), factor);
+}
+
+template< typename Operand, typename Result >
+constexpr ScaleExpression<Operand> operator *(Number factor, const VectorExpression<Operand, Result> & operand)
+{
+	return ScaleExpression<Operand>(operand.getDerived(), factor);
+}
+
+// vector * factor + offset, rounded once
+inline constexpr Vector2 fusedMultiplyAdd(Vector2 vector, Number factor, Vector2 offset)
+{
+	return ((wide(vector) * factor) + wide(offset)).evaluate();
+}
+
+// point + vector * factor, rounded once
+inline constexpr Point2 fusedMultiplyAdd(Vector2 vector, Number factor, Point2 point)
+{
+	return ((wide(vector) * factor) + wide(point)).evaluate();
+}